@@ -30,6 +30,18 @@
 #include "sbox.h"
 #include "gf256.h"
 
+/**
+ * The block functions are templates on the round count, so each key size gets its own
+ * kernel with a constant trip count that the compiler unrolls completely.
+ */
+#if defined(__clang__)
+#define AES_UNROLL _Pragma("clang loop unroll(full)")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define AES_UNROLL _Pragma("GCC unroll 16")
+#else
+#define AES_UNROLL
+#endif
+
 static const uint32_t RC[] = {
     0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
 };
@@ -51,197 +63,594 @@ static uint32_t sub_word(uint32_t value)
     return value;
 }
 
-static void add_round_keys(uint8_t* block, const uint8_t* rks) {
-    block[0] ^= rks[0];
-    block[1] ^= rks[4];
-    block[2] ^= rks[8];
-    block[3] ^= rks[12];
+/**
+ * The state is column-major like the block itself: column c is state[c], row r its byte r.
+ * A round key has the same layout, so AddRoundKey is four word XORs. With Flash set the
+ * schedule is in AES_RKS_MEM, which on AVR means copying the round key out of flash first.
+ */
+template <bool Flash>
+static void add_round_keys(uint32_t* state, const uint8_t* rks)
+{
+    const uint32_t* rk = (const uint32_t*) rks;
 
-    block[4] ^= rks[1];
-    block[5] ^= rks[5];
-    block[6] ^= rks[9];
-    block[7] ^= rks[13];
+#if defined(__AVR__)
+    uint32_t copy[4];
+    if (Flash) {
+        memcpy_P(copy, rks, 16);
+        rk = copy;
+    }
+#endif
 
-    block[8] ^= rks[2];
-    block[9] ^= rks[6];
-    block[10] ^= rks[10];
-    block[11] ^= rks[14];
+    state[0] ^= rk[0];
+    state[1] ^= rk[1];
+    state[2] ^= rk[2];
+    state[3] ^= rk[3];
+}
+
+/**
+ * SubBytes and ShiftRows in one pass: row r of column c comes from column c + r,
+ * so byte i = 4c + r reads byte i + 4r
+ */
+static void sub_shift_rows(uint32_t* state)
+{
+    uint8_t in[16];
+    uint8_t* out = (uint8_t*) state;
 
-    block[12] ^= rks[3];
-    block[13] ^= rks[7];
-    block[14] ^= rks[11];
-    block[15] ^= rks[15];
+    memcpy(in, state, 16);
+    for (int i = 0; i < 16; ++i) {
+        out[i] = affine_sbox(in[(i + 4 * (i & 3)) & 15]);
+    }
+}
+
+// row r of column c comes from column c - r, byte i reads byte i - 4r
+static void inv_sub_shift_rows(uint32_t* state)
+{
+    uint8_t in[16];
+    uint8_t* out = (uint8_t*) state;
+
+    memcpy(in, state, 16);
+    for (int i = 0; i < 16; ++i) {
+        out[i] = affine_sinv(in[(i + 12 * (i & 3)) & 15]);
+    }
 }
 
-static void swap(uint8_t* block, size_t pos1, size_t pos2)
+/**
+ * Products by the MixColumns coefficients. By default they are lookups in the generated
+ * GF256_MULn tables, read from flash on AVR. AES_SBOX_CONSTANT_TIME computes them with the
+ * branch-free gf256_xtime instead, so that no table index depends on the state.
+ */
+#if defined(AES_SBOX_CONSTANT_TIME)
+static inline uint8_t mix_mul2(uint8_t value)
 {
-    uint8_t tmp = block[pos1];
-    block[pos1] = block[pos2];
-    block[pos2] = tmp;
+    return gf256_xtime(value);
 }
 
-static void transpose(uint8_t* block)
+static inline uint8_t mix_mul3(uint8_t value)
 {
-    swap(block, 1, 4);
-    swap(block, 2, 8);
-    swap(block, 3, 12);
-    swap(block, 6, 9);
-    swap(block, 7, 13);
-    swap(block, 11, 14);
+    return gf256_xtime(value) ^ value;
+}
+#else
+static inline uint8_t mix_mul2(uint8_t value)
+{
+    return gf256_read(GF256_MUL2, value);
 }
 
-static void sub_bytes(uint8_t* block)
+static inline uint8_t mix_mul3(uint8_t value)
 {
-    for (int i = 0; i < 16; ++i) {
-        block[i] = affine_sbox(block[i]);
+    return gf256_read(GF256_MUL3, value);
+}
+#endif
+
+// column c is bytes 4c to 4c + 3 of the state
+static void mix_columns(uint32_t* state)
+{
+    uint8_t* col = (uint8_t*) state;
+
+    for (int c = 0; c < 4; ++c, col += 4) {
+        uint8_t a0 = col[0];
+        uint8_t a1 = col[1];
+        uint8_t a2 = col[2];
+        uint8_t a3 = col[3];
+
+        col[0] = mix_mul2(a0) ^ mix_mul3(a1) ^ a2 ^ a3;
+        col[1] = a0 ^ mix_mul2(a1) ^ mix_mul3(a2) ^ a3;
+        col[2] = a0 ^ a1 ^ mix_mul2(a2) ^ mix_mul3(a3);
+        col[3] = mix_mul3(a0) ^ a1 ^ a2 ^ mix_mul2(a3);
     }
 }
 
-static void inv_sub_bytes(uint8_t* block) 
+#if defined(AES_SBOX_CONSTANT_TIME)
+/**
+ * InvMixColumns is MixColumns after adding 4 * (a0 + a2) to rows 0 and 2 and 4 * (a1 + a3)
+ * to rows 1 and 3, which keeps the computed path to a few xtimes per column
+ */
+static void inv_mix_columns(uint32_t* state)
 {
-    for (int i = 0; i < 16; ++i) {
-        block[i] = affine_sinv(block[i]);
+    uint8_t* col = (uint8_t*) state;
+
+    for (int c = 0; c < 4; ++c, col += 4) {
+        uint8_t even = gf256_xtime(gf256_xtime(col[0] ^ col[2]));
+        uint8_t odd = gf256_xtime(gf256_xtime(col[1] ^ col[3]));
+
+        col[0] ^= even;
+        col[1] ^= odd;
+        col[2] ^= even;
+        col[3] ^= odd;
+    }
+
+    mix_columns(state);
+}
+#else
+static void inv_mix_columns(uint32_t* state)
+{
+    uint8_t* col = (uint8_t*) state;
+
+    for (int c = 0; c < 4; ++c, col += 4) {
+        uint8_t a0 = col[0];
+        uint8_t a1 = col[1];
+        uint8_t a2 = col[2];
+        uint8_t a3 = col[3];
+
+        col[0] = gf256_read(GF256_MUL14, a0) ^ gf256_read(GF256_MUL11, a1) ^ gf256_read(GF256_MUL13, a2) ^ gf256_read(GF256_MUL9, a3);
+        col[1] = gf256_read(GF256_MUL9, a0) ^ gf256_read(GF256_MUL14, a1) ^ gf256_read(GF256_MUL11, a2) ^ gf256_read(GF256_MUL13, a3);
+        col[2] = gf256_read(GF256_MUL13, a0) ^ gf256_read(GF256_MUL9, a1) ^ gf256_read(GF256_MUL14, a2) ^ gf256_read(GF256_MUL11, a3);
+        col[3] = gf256_read(GF256_MUL11, a0) ^ gf256_read(GF256_MUL13, a1) ^ gf256_read(GF256_MUL9, a2) ^ gf256_read(GF256_MUL14, a3);
     }
 }
+#endif
 
-static void shift_rows(uint8_t* block)
+/**
+ * Rounds First to Rounds of a state that has been through round First - 1,
+ * rks points to the round key of round First
+ */
+template <size_t Rounds, size_t First, bool Flash>
+static void encrypt_rounds(uint32_t* state, const uint8_t* rks)
+{
+    AES_UNROLL
+    for (size_t i = First; i < Rounds; ++i, rks += 16)
+    {
+        sub_shift_rows(state);
+        mix_columns(state);
+        add_round_keys<Flash>(state, rks);
+    }
+
+    sub_shift_rows(state);
+    add_round_keys<Flash>(state, rks);
+}
+
+template <size_t Rounds, bool Flash>
+static void aes_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    uint8_t tmp = block[4];
-    block[4] = block[5];
-    block[5] = block[6];
-    block[6] = block[7];
-    block[7] = tmp;
+    uint32_t state[4];
+    memcpy(state, pt, 16);
 
-    swap(block, 8, 10);
-    swap(block, 9, 11);
+    add_round_keys<Flash>(state, rks);
+    encrypt_rounds<Rounds, 1, Flash>(state, rks + 16);
 
-    tmp = block[15];
-    block[15] = block[14];
-    block[14] = block[13];
-    block[13] = block[12];
-    block[12] = tmp;
+    memcpy(ct, state, 16);
 }
 
-static void inv_shift_rows(uint8_t* block)
+template <size_t Rounds, bool Flash>
+static void aes_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
 {
-    uint8_t tmp = block[7];
-    block[7] = block[6];
-    block[6] = block[5];
-    block[5] = block[4];
-    block[4] = tmp;
+    uint32_t state[4];
+    memcpy(state, ct, 16);
+
+    rks += 16 * Rounds;
 
-    swap(block, 8, 10);
-    swap(block, 9, 11);
+    add_round_keys<Flash>(state, rks);
+    rks -= 16;
 
-    tmp = block[12];
-    block[12] = block[13];
-    block[13] = block[14];
-    block[14] = block[15];
-    block[15] = tmp;
+    AES_UNROLL
+    for (size_t i = 0; i < Rounds - 1; ++i, rks -= 16)
+    {
+        inv_sub_shift_rows(state);
+        add_round_keys<Flash>(state, rks);
+        inv_mix_columns(state);
+    }
+
+    inv_sub_shift_rows(state);
+    add_round_keys<Flash>(state, rks);
+
+    memcpy(pt, state, 16);
+}
+
+/**
+ * MixColumns column produced by S(value) sitting in row row, i.e. column row of the
+ * MixColumns matrix times S(value). Row k of the matrix holds (2, 3, 1, 1) rotated right
+ * by k, so the two products are taken once with the mix_columns helpers and placed by row.
+ */
+static uint32_t mix_byte(uint8_t value, size_t row)
+{
+    uint32_t sub = affine_sbox(value);
+    uint32_t out = mix_mul2(sub) ^ (sub << 8) ^ (sub << 16) ^ ((uint32_t) mix_mul3(sub) << 24);
+
+    return (out << (8 * row)) | (out >> ((32 - 8 * row) & 31));
 }
 
-static void mix_columns(uint8_t* in)
+/**
+ * Round 2 terms of column 0 of the round 1 output: ShiftRows moves its byte in row r
+ * to column -r, so every column gets exactly one of them. XORing them in adds them to
+ * a round 2 state that lacks them, or takes them out of a full one.
+ */
+static void ctr_round2_terms(uint32_t* state, uint32_t col)
 {
-    uint8_t block[16] = {0};
+    uint32_t terms[4];
+
+    terms[0] = mix_byte(col, 0);
+    terms[3] = mix_byte(col >> 8, 1);
+    terms[2] = mix_byte(col >> 16, 2);
+    terms[1] = mix_byte(col >> 24, 3);
 
-    for (int i = 0; i < 4; ++i) {
-        block[i     ] = gf256_mul(in[i], 2) ^ gf256_mul(in[i + 4], 3) ^ gf256_mul(in[i + 8], 1) ^ gf256_mul(in[i + 12], 1);
-        block[i +  4] = gf256_mul(in[i], 1) ^ gf256_mul(in[i + 4], 2) ^ gf256_mul(in[i + 8], 3) ^ gf256_mul(in[i + 12], 1);
-        block[i +  8] = gf256_mul(in[i], 1) ^ gf256_mul(in[i + 4], 1) ^ gf256_mul(in[i + 8], 2) ^ gf256_mul(in[i + 12], 3);
-        block[i + 12] = gf256_mul(in[i], 3) ^ gf256_mul(in[i + 4], 1) ^ gf256_mul(in[i + 8], 1) ^ gf256_mul(in[i + 12], 2);
+    for (size_t c = 0; c < 4; ++c) {
+        state[c] ^= terms[c];
     }
+}
 
-    memcpy(in, block, 16);
+/**
+ * Rounds 1 and 2 of a counter block that only changes in byte 15. That byte lands in row 3
+ * of column 0 in round 1, so only that column of the round 1 output changes, and round 2
+ * mixes one of its bytes into every column. The cache holds round 1 column 0 and the
+ * round 2 state without the terms of the varying byte, 5 S-box and MixColumns lookups
+ * per block instead of 32.
+ */
+struct ctr_cache {
+    uint8_t k15;
+    uint32_t col;
+    uint32_t state[4];
+};
+
+template <bool Flash>
+static void ctr_prepare(ctr_cache& c, const uint8_t* ctr, const uint8_t* rks)
+{
+    uint32_t state[4];
+    memcpy(state, ctr, 16);
+
+    add_round_keys<Flash>(state, rks);
+    uint8_t x = ((const uint8_t*) state)[15];
+    c.k15 = x ^ ctr[15];
+
+    sub_shift_rows(state);
+    mix_columns(state);
+    add_round_keys<Flash>(state, rks + 16);
+    uint32_t col = state[0];
+    c.col = col ^ mix_byte(x, 3);
+
+    sub_shift_rows(state);
+    mix_columns(state);
+    add_round_keys<Flash>(state, rks + 32);
+    ctr_round2_terms(state, col);
+    memcpy(c.state, state, 16);
 }
 
-static void inv_mix_columns(uint8_t* in)
+// big endian counter increment, returns the index of the most significant byte that changed
+static size_t increment_counter(uint8_t* ctr)
 {
-    uint8_t block[16] = {0};
+    size_t idx = 15;
+    while (++ctr[idx] == 0 && idx != 0) {
+        --idx;
+    }
+    return idx;
+}
 
-    for (int i = 0; i < 4; ++i) {
-        block[i     ] = gf256_mul(in[i], 0xe) ^ gf256_mul(in[i + 4], 0xb) ^ gf256_mul(in[i + 8], 0xd) ^ gf256_mul(in[i + 12], 0x9);
-        block[i +  4] = gf256_mul(in[i], 0x9) ^ gf256_mul(in[i + 4], 0xe) ^ gf256_mul(in[i + 8], 0xb) ^ gf256_mul(in[i + 12], 0xd);
-        block[i +  8] = gf256_mul(in[i], 0xd) ^ gf256_mul(in[i + 4], 0x9) ^ gf256_mul(in[i + 8], 0xe) ^ gf256_mul(in[i + 12], 0xb);
-        block[i + 12] = gf256_mul(in[i], 0xb) ^ gf256_mul(in[i + 4], 0xd) ^ gf256_mul(in[i + 8], 0x9) ^ gf256_mul(in[i + 12], 0xe);
+/**
+ * Whole CTR blocks from the cached rounds 1 and 2, refreshed when the carry leaves byte 15
+ */
+template <size_t Rounds, bool Flash>
+static void aes_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    uint32_t state[4];
+    ctr_cache c;
+    bool stale = true;
+
+    for (; blocks > 0; --blocks) {
+        if (stale) {
+            ctr_prepare<Flash>(c, ctr, rks);
+        }
+
+        uint32_t col = c.col ^ mix_byte(ctr[15] ^ c.k15, 3);
+        memcpy(state, c.state, 16);
+        ctr_round2_terms(state, col);
+        encrypt_rounds<Rounds, 3, Flash>(state, rks + 48);
+
+        const uint8_t* ks = (const uint8_t*) state;
+        for (size_t i = 0; i < 16; ++i) {
+            out[i] = in[i] ^ ks[i];
+        }
+
+        stale = increment_counter(ctr) < 15;
+        in += 16;
+        out += 16;
     }
+}
+
+/**
+ * FIPS-197 key expansion for a key of Nk words, Nk + 6 rounds
+ */
+template <size_t Nk>
+static void aes_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    const size_t words = 4 * (Nk + 7);
+    uint32_t* rk = (uint32_t*) rks;
+
+    memcpy(rk, mk, 4 * Nk);
+
+    for (size_t i = Nk; i < words; ++i) {
+        uint32_t tmp = rk[i - 1];
 
-    memcpy(in, block, 16);
+        if (i % Nk == 0) {
+            tmp = sub_word(rot32r8(tmp)) ^ RC[i / Nk - 1];
+        } else if (Nk > 6 && i % Nk == 4) {
+            tmp = sub_word(tmp);
+        }
+
+        rk[i] = rk[i - Nk] ^ tmp;
+    }
 }
 
-static void aes_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t rounds)
+/**
+ * One step of the key expansion on a window of Nk schedule words, word i kept in w[i % Nk].
+ * Word i and word i - Nk share a slot and differ by a function of word i - 1, so the same
+ * step moves the window forward over the schedule or back.
+ */
+template <size_t Nk>
+static void otf_step(uint32_t* w, size_t i)
 {
-    uint8_t block[16] = {0};
-    memcpy(block, pt, 16);
-    transpose(block);
+    uint32_t tmp = w[(i - 1) % Nk];
 
-    add_round_keys(block, rks);
-    rks += 16;
+    if (i % Nk == 0) {
+        tmp = sub_word(rot32r8(tmp)) ^ RC[i / Nk - 1];
+    } else if (Nk > 6 && i % Nk == 4) {
+        tmp = sub_word(tmp);
+    }
 
-    for (int i = 0; i < rounds - 1; ++i, rks += 16)
-    {
-        sub_bytes(block);
-        shift_rows(block);
-        mix_columns(block);
-        add_round_keys(block, rks);
+    w[i % Nk] ^= tmp;
+}
+
+/**
+ * Copies the round key of the given round out of the window, first sliding the window
+ * so that it holds words 4 * round to 4 * round + 3. lo is the oldest word in the window.
+ */
+template <size_t Nk>
+static void otf_round_key(uint32_t* rk, uint32_t* w, size_t* lo, size_t round)
+{
+    const size_t first = 4 * round;
+
+    while (*lo + Nk < first + 4) {
+        otf_step<Nk>(w, *lo + Nk);
+        ++*lo;
     }
 
-    sub_bytes(block);
-    shift_rows(block);
-    add_round_keys(block, rks);
+    while (*lo > first) {
+        --*lo;
+        otf_step<Nk>(w, *lo + Nk);
+    }
 
-    transpose(block);
-    memcpy(ct, block, 16);
+    for (size_t k = 0; k < 4; ++k) {
+        rk[k] = w[(first + k) % Nk];
+    }
 }
 
-static void aes_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t rounds)
+template <size_t Nk>
+static void aes_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
 {
-    uint8_t block[16] = {0};
-    memcpy(block, ct, 16);
-    transpose(block);
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    size_t lo = 0;
 
-    rks += 16 * rounds;
+    memcpy(w, mk, 4 * Nk);
+    otf_round_key<Nk>(rk, w, &lo, Nk + 6);
+    memcpy(dk, w, 4 * Nk);
+}
 
-    add_round_keys(block, rks);
-    rks -= 16;
+template <size_t Nk>
+static void aes_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    const size_t rounds = Nk + 6;
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    size_t lo = 0;
 
-    for (int i = 0; i < rounds - 1; ++i, rks -= 16)
-    {
-        inv_shift_rows(block);
-        inv_sub_bytes(block);
-        add_round_keys(block, rks);
-        inv_mix_columns(block);
+    uint32_t state[4];
+    memcpy(state, pt, 16);
+
+    memcpy(w, mk, 4 * Nk);
+    otf_round_key<Nk>(rk, w, &lo, 0);
+    add_round_keys<false>(state, (const uint8_t*) rk);
+
+    for (size_t round = 1; round < rounds; ++round) {
+        otf_round_key<Nk>(rk, w, &lo, round);
+
+        sub_shift_rows(state);
+        mix_columns(state);
+        add_round_keys<false>(state, (const uint8_t*) rk);
     }
 
-    inv_sub_bytes(block);
-    inv_shift_rows(block);
-    add_round_keys(block, rks);
+    otf_round_key<Nk>(rk, w, &lo, rounds);
 
-    transpose(block);
-    memcpy(pt, block, 16);
+    sub_shift_rows(state);
+    add_round_keys<false>(state, (const uint8_t*) rk);
+
+    memcpy(ct, state, 16);
 }
 
-void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+template <size_t Nk>
+static void aes_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
 {
-    const uint32_t* key = (const uint32_t*) mk;
-    uint32_t* rk = (uint32_t*) rks;
+    const size_t rounds = Nk + 6;
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    size_t lo = 4 * (rounds + 1) - Nk;
 
-    memcpy(rk, key, 16);
+    uint32_t state[4];
+    memcpy(state, ct, 16);
 
-    for (int i = 0; i < 10; ++i) {
-        rk[4] = rk[0] ^ sub_word(rot32r8(rk[3])) ^ RC[i];
-        rk[5] = rk[1] ^ rk[4];
-        rk[6] = rk[2] ^ rk[5];
-        rk[7] = rk[3] ^ rk[6];
-        rk += 4;
+    memcpy(w, dk, 4 * Nk);
+    otf_round_key<Nk>(rk, w, &lo, rounds);
+    add_round_keys<false>(state, (const uint8_t*) rk);
+
+    for (size_t round = rounds - 1; round > 0; --round) {
+        otf_round_key<Nk>(rk, w, &lo, round);
+
+        inv_sub_shift_rows(state);
+        add_round_keys<false>(state, (const uint8_t*) rk);
+        inv_mix_columns(state);
     }
+
+    otf_round_key<Nk>(rk, w, &lo, 0);
+
+    inv_sub_shift_rows(state);
+    add_round_keys<false>(state, (const uint8_t*) rk);
+
+    memcpy(pt, state, 16);
+}
+
+void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<4>(rks, mk);
 }
 
 void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    aes_encrypt(ct, pt, rks, AES128_ROUNDS);
+    aes_encrypt<AES128_ROUNDS, false>(ct, pt, rks);
+}
+
+void aes128_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES128_ROUNDS, true>(ct, pt, rks);
 }
 
 void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
 {
-    aes_decrypt(pt, ct, rks, AES128_ROUNDS);
+    aes_decrypt<AES128_ROUNDS, false>(pt, ct, rks);
+}
+
+void aes128_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES128_ROUNDS, true>(pt, ct, rks);
+}
+
+void aes128_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES128_ROUNDS, false>(out, in, ctr, rks, blocks);
+}
+
+void aes128_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES128_ROUNDS, true>(out, in, ctr, rks, blocks);
+}
+
+void aes192_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<6>(rks, mk);
+}
+
+void aes192_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES192_ROUNDS, false>(ct, pt, rks);
+}
+
+void aes192_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES192_ROUNDS, true>(ct, pt, rks);
+}
+
+void aes192_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES192_ROUNDS, false>(pt, ct, rks);
+}
+
+void aes192_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES192_ROUNDS, true>(pt, ct, rks);
+}
+
+void aes192_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES192_ROUNDS, false>(out, in, ctr, rks, blocks);
+}
+
+void aes192_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES192_ROUNDS, true>(out, in, ctr, rks, blocks);
+}
+
+void aes256_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<8>(rks, mk);
+}
+
+void aes256_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES256_ROUNDS, false>(ct, pt, rks);
+}
+
+void aes256_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES256_ROUNDS, true>(ct, pt, rks);
+}
+
+void aes256_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES256_ROUNDS, false>(pt, ct, rks);
+}
+
+void aes256_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES256_ROUNDS, true>(pt, ct, rks);
+}
+
+void aes256_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES256_ROUNDS, false>(out, in, ctr, rks, blocks);
+}
+
+void aes256_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES256_ROUNDS, true>(out, in, ctr, rks, blocks);
+}
+
+void aes128_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<4>(dk, mk);
+}
+
+void aes128_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<4>(ct, pt, mk);
+}
+
+void aes128_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<4>(pt, ct, dk);
+}
+
+void aes192_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<6>(dk, mk);
+}
+
+void aes192_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<6>(ct, pt, mk);
+}
+
+void aes192_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<6>(pt, ct, dk);
+}
+
+void aes256_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<8>(dk, mk);
+}
+
+void aes256_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<8>(ct, pt, mk);
+}
+
+void aes256_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<8>(pt, ct, dk);
 }
@@ -31,7 +31,72 @@
 #include <stddef.h>
 
 #define AES128_ROUNDS 10
+#define AES192_ROUNDS 12
+#define AES256_ROUNDS 14
 
+// round key bytes per key size, AES_MAX_RKS_SIZE fits any of them
+#define AES128_RKS_SIZE ((AES128_ROUNDS + 1) * 16)
+#define AES192_RKS_SIZE ((AES192_ROUNDS + 1) * 16)
+#define AES256_RKS_SIZE ((AES256_ROUNDS + 1) * 16)
+#define AES_MAX_RKS_SIZE AES256_RKS_SIZE
+#define AES_MAX_KEY_SIZE 32
+
+/**
+ * Schedules expanded ahead of time, such as the constexpr ones from aes_const.h, are declared
+ * with AES_RKS_MEM and passed to the _P functions. On AVR that puts them in flash, and the _P
+ * functions copy out one round key at a time; elsewhere they are ordinary read-only data.
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define AES_RKS_MEM PROGMEM
+#else
+#define AES_RKS_MEM
+#endif
+
+/**
+ * The encrypt_ctr functions xor blocks whole CTR keystream blocks into out and advance the
+ * big endian counter ctr past them. Rounds 1 and 2 of a counter block are cached for as long
+ * as only its last byte changes.
+ */
 void aes128_keygen(uint8_t* rks, const uint8_t* mk);
 void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
 void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes128_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes128_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes128_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void aes128_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+
+void aes192_keygen(uint8_t* rks, const uint8_t* mk);
+void aes192_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes192_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes192_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes192_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes192_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void aes192_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+
+void aes256_keygen(uint8_t* rks, const uint8_t* mk);
+void aes256_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes256_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes256_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes256_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+void aes256_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void aes256_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+
+/**
+ * On-the-fly key expansion: round keys are expanded one round at a time while the block is
+ * processed, so no schedule is stored. Encryption reads the key itself. Decryption starts from
+ * dk, the last key-size bytes of the schedule made by keygen_otf_decrypt, and runs the
+ * schedule backwards; for AES-128 dk is the final round key.
+ * Define AES_ON_THE_FLY to make the ECB and CTR modes use these functions.
+ */
+void aes128_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void aes128_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk);
+void aes128_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk);
+
+void aes192_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void aes192_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk);
+void aes192_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk);
+
+void aes256_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void aes256_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk);
+void aes256_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk);
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes.h"
+
+/**
+ * Versioned container for an expanded key schedule, for keys provisioned at run time and
+ * kept in EEPROM or a file so that a reboot does not have to run keygen again.
+ *
+ *   offset 0  'K' 'S'      magic
+ *   offset 2  version      AES_BLOB_VERSION
+ *   offset 3  algorithm    AES_BLOB_AES128, AES_BLOB_AES192 or AES_BLOB_AES256
+ *   offset 4  type         AES_BLOB_ENCRYPT
+ *   offset 5  reserved     0
+ *   offset 6  checksum     Fletcher-16 of bytes 0 to 5 and the schedule, little endian
+ *   offset 8  round keys   exactly as keygen wrote them
+ *
+ * The checksum catches worn or half-written storage, it is not a MAC. The schedule starts
+ * 8 bytes in, so a 4-byte aligned blob hands the cipher an aligned schedule.
+ */
+#define AES_BLOB_VERSION 1
+#define AES_BLOB_HEADER_SIZE 8
+#define AES_BLOB_SIZE(rks_size) (AES_BLOB_HEADER_SIZE + (rks_size))
+#define AES_MAX_BLOB_SIZE AES_BLOB_SIZE(AES_MAX_RKS_SIZE)
+
+#define AES_BLOB_AES128 0x01
+#define AES_BLOB_AES192 0x02
+#define AES_BLOB_AES256 0x03
+
+#define AES_BLOB_ENCRYPT 0x00
+
+/**
+ * Writes the schedule made by aesxxx_keygen for a key of keysize bytes into blob, which needs
+ * AES_BLOB_SIZE(AESxxx_RKS_SIZE) bytes. Returns the blob length, 0 if keysize is not 16, 24 or 32.
+ */
+size_t aes_blob_store(uint8_t* blob, const uint8_t* rks, size_t keysize);
+
+/**
+ * Checks length bytes read back from storage and returns the schedule inside the blob, to be
+ * passed straight to aesxxx_encrypt and aesxxx_decrypt. Returns NULL if the blob is not for
+ * keysize, has another version or fails the checksum.
+ */
+const uint8_t* aes_blob_load(const uint8_t* blob, size_t length, size_t keysize);
\ No newline at end of file
@@ -0,0 +1,153 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes.h"
+#include "gf256.h"
+
+/**
+ * Compile-time AES key schedules for devices that keep one key for their whole life.
+ * With the key in a constexpr array,
+ *
+ *     constexpr uint8_t DEVICE_KEY[16] = { ... };
+ *     const uint8_t DEVICE_RKS[AES128_RKS_SIZE] AES_RKS_MEM = { AES128_KEYGEN_CONST(DEVICE_KEY) };
+ *
+ * the compiler expands the schedule into flash, where the _P block and mode functions read it
+ * without running keygen. The result is byte for byte what aes128_keygen writes.
+ * Written as single-expression recursions so that they stay valid C++11.
+ */
+constexpr uint8_t aes_rot8l_const(uint8_t value, int shift)
+{
+    return (uint8_t) ((value << shift) | (value >> (8 - shift)));
+}
+
+// the affine transform as a sum of rotations
+constexpr uint8_t aes_affine_const(uint8_t value)
+{
+    return (uint8_t) (value ^ aes_rot8l_const(value, 1) ^ aes_rot8l_const(value, 2) ^ aes_rot8l_const(value, 3) ^ aes_rot8l_const(value, 4) ^ 0x63);
+}
+
+#define AES_SBOX_CONST_ENTRY(x) aes_affine_const(gf256_inv_const(x))
+
+// evaluated once per translation unit, the schedule below looks bytes up instead of inverting them
+static constexpr uint8_t AES_SBOX_CONST[256] = { GF256_TABLE(AES_SBOX_CONST_ENTRY) };
+
+constexpr uint32_t aes_sub_word_const(uint32_t value)
+{
+    return (uint32_t) AES_SBOX_CONST[value & 0xff] ^ ((uint32_t) AES_SBOX_CONST[(value >> 8) & 0xff] << 8)
+        ^ ((uint32_t) AES_SBOX_CONST[(value >> 16) & 0xff] << 16) ^ ((uint32_t) AES_SBOX_CONST[value >> 24] << 24);
+}
+
+// RC[n] = x^n
+constexpr uint32_t aes_rcon_const(size_t n)
+{
+    return n == 0 ? 1 : gf256_xtime_const(aes_rcon_const(n - 1));
+}
+
+constexpr uint32_t aes_key_word_const(const uint8_t* mk, size_t j)
+{
+    return (uint32_t) mk[4 * j] ^ ((uint32_t) mk[4 * j + 1] << 8) ^ ((uint32_t) mk[4 * j + 2] << 16) ^ ((uint32_t) mk[4 * j + 3] << 24);
+}
+
+// word i of the schedule is word i - nk xor this function of word i - 1
+constexpr uint32_t aes_schedule_f_const(uint32_t prev, size_t nk, size_t i)
+{
+    return i % nk == 0 ? aes_sub_word_const((prev >> 8) ^ (prev << 24)) ^ aes_rcon_const(i / nk - 1)
+         : (nk > 6 && i % nk == 4) ? aes_sub_word_const(prev) : prev;
+}
+
+/**
+ * The last eight schedule words, the newest in w[7]. Walking the schedule forward one word at
+ * a time keeps the recursion linear in the schedule length.
+ */
+struct aes_window_const {
+    uint32_t w[8];
+};
+
+constexpr aes_window_const aes_window_push_const(aes_window_const a, uint32_t next)
+{
+    return {{ a.w[1], a.w[2], a.w[3], a.w[4], a.w[5], a.w[6], a.w[7], next }};
+}
+
+// window ending at word last, from the window ending at word i - 1
+constexpr aes_window_const aes_window_walk_const(aes_window_const a, size_t nk, size_t i, size_t last)
+{
+    return i > last ? a : aes_window_walk_const(aes_window_push_const(a, a.w[8 - nk] ^ aes_schedule_f_const(a.w[7], nk, i)), nk, i + 1, last);
+}
+
+constexpr uint32_t aes_first_window_word_const(const uint8_t* mk, size_t nk, size_t e)
+{
+    return e + nk >= 8 ? aes_key_word_const(mk, e + nk - 8) : 0;
+}
+
+// window ending at word nk - 1, the key itself
+constexpr aes_window_const aes_first_window_const(const uint8_t* mk, size_t nk)
+{
+    return {{ aes_first_window_word_const(mk, nk, 0), aes_first_window_word_const(mk, nk, 1),
+              aes_first_window_word_const(mk, nk, 2), aes_first_window_word_const(mk, nk, 3),
+              aes_first_window_word_const(mk, nk, 4), aes_first_window_word_const(mk, nk, 5),
+              aes_first_window_word_const(mk, nk, 6), aes_first_window_word_const(mk, nk, 7) }};
+}
+
+constexpr uint32_t aes_rk_word_const(const uint8_t* mk, size_t nk, size_t i)
+{
+    return i < nk ? aes_key_word_const(mk, i) : aes_window_walk_const(aes_first_window_const(mk, nk), nk, nk, i).w[7];
+}
+
+constexpr uint8_t aes_rk_byte_const(const uint8_t* mk, size_t nk, size_t index)
+{
+    return (uint8_t) (aes_rk_word_const(mk, nk, index / 4) >> (8 * (index % 4)));
+}
+
+#define AES_RKS_CONST_ROUND(mk, nk, r) \
+    aes_rk_byte_const(mk, nk, 16 * (r) +  0), aes_rk_byte_const(mk, nk, 16 * (r) +  1), \
+    aes_rk_byte_const(mk, nk, 16 * (r) +  2), aes_rk_byte_const(mk, nk, 16 * (r) +  3), \
+    aes_rk_byte_const(mk, nk, 16 * (r) +  4), aes_rk_byte_const(mk, nk, 16 * (r) +  5), \
+    aes_rk_byte_const(mk, nk, 16 * (r) +  6), aes_rk_byte_const(mk, nk, 16 * (r) +  7), \
+    aes_rk_byte_const(mk, nk, 16 * (r) +  8), aes_rk_byte_const(mk, nk, 16 * (r) +  9), \
+    aes_rk_byte_const(mk, nk, 16 * (r) + 10), aes_rk_byte_const(mk, nk, 16 * (r) + 11), \
+    aes_rk_byte_const(mk, nk, 16 * (r) + 12), aes_rk_byte_const(mk, nk, 16 * (r) + 13), \
+    aes_rk_byte_const(mk, nk, 16 * (r) + 14), aes_rk_byte_const(mk, nk, 16 * (r) + 15)
+
+#define AES_RKS_CONST_ROUNDS_0_10(f, mk, nk) \
+    f(mk, nk, 0), f(mk, nk, 1), f(mk, nk, 2), f(mk, nk, 3), f(mk, nk, 4), f(mk, nk, 5), \
+    f(mk, nk, 6), f(mk, nk, 7), f(mk, nk, 8), f(mk, nk, 9), f(mk, nk, 10)
+
+#define AES128_KEYGEN_CONST(mk) \
+    AES_RKS_CONST_ROUNDS_0_10(AES_RKS_CONST_ROUND, mk, 4)
+
+#define AES192_KEYGEN_CONST(mk) \
+    AES_RKS_CONST_ROUNDS_0_10(AES_RKS_CONST_ROUND, mk, 6), \
+    AES_RKS_CONST_ROUND(mk, 6, 11), AES_RKS_CONST_ROUND(mk, 6, 12)
+
+#define AES256_KEYGEN_CONST(mk) \
+    AES_RKS_CONST_ROUNDS_0_10(AES_RKS_CONST_ROUND, mk, 8), \
+    AES_RKS_CONST_ROUND(mk, 8, 11), AES_RKS_CONST_ROUND(mk, 8, 12), \
+    AES_RKS_CONST_ROUND(mk, 8, 13), AES_RKS_CONST_ROUND(mk, 8, 14)
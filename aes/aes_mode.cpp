@@ -26,94 +26,275 @@
  */
 
 #include "aes.h"
+#include "aes_mode.h"
+#include <block_mode.h>
 #include "HardwareSerial.h"
 
-void aes_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+#if defined(AES_ON_THE_FLY)
+/**
+ * Round keys are expanded inside every block call: encryption reads the key directly,
+ * so keygen only copies it, and decryption keeps only the tail of the schedule.
+ * CTR blocks go one at a time, the cached rounds need a stored schedule.
+ */
+typedef mode_cipher<16, 16, 16, mode_copy_key<16>, aes128_keygen_otf_decrypt, aes128_encrypt_otf, aes128_decrypt_otf> AES128;
+typedef mode_cipher<24, 24, 24, mode_copy_key<24>, aes192_keygen_otf_decrypt, aes192_encrypt_otf, aes192_decrypt_otf> AES192;
+typedef mode_cipher<32, 32, 32, mode_copy_key<32>, aes256_keygen_otf_decrypt, aes256_encrypt_otf, aes256_decrypt_otf> AES256;
+#else
+typedef mode_cipher<16, AES128_RKS_SIZE, AES128_RKS_SIZE, aes128_keygen, aes128_keygen, aes128_encrypt, aes128_decrypt, mode_ctr_kernel<aes128_encrypt_ctr> > AES128;
+typedef mode_cipher<24, AES192_RKS_SIZE, AES192_RKS_SIZE, aes192_keygen, aes192_keygen, aes192_encrypt, aes192_decrypt, mode_ctr_kernel<aes192_encrypt_ctr> > AES192;
+typedef mode_cipher<32, AES256_RKS_SIZE, AES256_RKS_SIZE, aes256_keygen, aes256_keygen, aes256_encrypt, aes256_decrypt, mode_ctr_kernel<aes256_encrypt_ctr> > AES256;
+#endif
+
+// the same on a schedule in AES_RKS_MEM
+typedef mode_cipher<16, AES128_RKS_SIZE, AES128_RKS_SIZE, aes128_keygen, aes128_keygen, aes128_encrypt_P, aes128_decrypt_P, mode_ctr_kernel<aes128_encrypt_ctr_P> > AES128_P;
+typedef mode_cipher<24, AES192_RKS_SIZE, AES192_RKS_SIZE, aes192_keygen, aes192_keygen, aes192_encrypt_P, aes192_decrypt_P, mode_ctr_kernel<aes192_encrypt_ctr_P> > AES192_P;
+typedef mode_cipher<32, AES256_RKS_SIZE, AES256_RKS_SIZE, aes256_keygen, aes256_keygen, aes256_encrypt_P, aes256_decrypt_P, mode_ctr_kernel<aes256_encrypt_ctr_P> > AES256_P;
+
+static const mode_table* select_cipher(size_t keysize)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
+    switch (keysize) {
+    case 16:
+        return &mode_table_of<AES128, AES128_P>::table;
+    case 24:
+        return &mode_table_of<AES192, AES192_P>::table;
+    case 32:
+        return &mode_table_of<AES256, AES256_P>::table;
+    }
+
+    Serial.println("key size is not 16, 24 or 32");
+    return NULL;
+}
+
+static bool check_length(size_t length)
+{
+    if (length % 16 != 0) {
         Serial.println("length is not multiple of 16");
-        return; 
+        return false;
+    }
+    return true;
+}
+
+void aes_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
 
-    uint8_t rks[(AES128_ROUNDS + 1) * blocksize] = {0,};
-    aes128_keygen(rks, key);
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-    while (length > 0) {
-        aes128_encrypt(out, in, rks);
+    mode_table_read(cipher, ecb_encrypt_key)(out, in, key, length);
+}
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+void aes_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, ecb_decrypt_key)(out, in, key, length);
 }
 
-void aes_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+void aes_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
-        Serial.println("length is not multiple of 16");
-        return; 
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, ctr_encrypt_key)(out, in, key, ctr, length);
+}
+
+void aes_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    aes_ctr_encrypt(out, in, key, keysize, ctr, length);  
+}
+
+void aes_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_encrypt_key)(out, in, key, iv, length);
+}
+
+void aes_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_decrypt_key)(out, in, key, iv, length);
+}
+
+void aes_ecb_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
 
-    uint8_t rks[(AES128_ROUNDS + 1) * blocksize] = {0,};
-    aes128_keygen(rks, key);
+    mode_table_read(cipher, ecb_encrypt_P)(out, in, rks, length);
+}
+
+void aes_ecb_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, ecb_decrypt_P)(out, in, rks, length);
+}
+
+void aes_ctr_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-    while (length > 0) {
-        aes128_decrypt(out, in, rks);
+    mode_table_read(cipher, ctr_encrypt_P)(out, in, rks, ctr, length);
+}
+
+void aes_ctr_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    aes_ctr_encrypt_P(out, in, rks, keysize, ctr, length);
+}
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+void aes_cbc_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_encrypt_P)(out, in, rks, iv, length);
 }
 
-static void xor_bytes(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs, size_t length)
+void aes_cbc_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
 {
-    for (int i = 0; i < length; ++i) {
-      out[i] = lhs[i] ^ rhs[i];
+    if (!check_length(length)) {
+        return;
     }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_decrypt_P)(out, in, rks, iv, length);
 }
 
-static void increase_counter(uint8_t* ctr_copy, size_t blocksize)
+bool aes_ctx_init(aes_ctx* ctx, const uint8_t* key, size_t keysize)
 {
-    int idx = blocksize - 1;
-    while ( (++ctr_copy[idx]) == 0 && idx != 0) {
-        --idx;
+    ctx->cipher = select_cipher(keysize);
+    if (ctx->cipher == NULL) {
+        return false;
     }
+
+    mode_table_read(ctx->cipher, keygen)(ctx->rks, key);
+#if defined(AES_ON_THE_FLY)
+    mode_table_read(ctx->cipher, keygen_decrypt)(ctx->drks, key);
+#endif
+    return true;
 }
 
-void aes_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+// on the fly decryption starts from the schedule tail, otherwise one schedule serves both directions
+static const uint8_t* decrypt_rks(const aes_ctx* ctx)
 {
-    const size_t blocksize = 16;
+#if defined(AES_ON_THE_FLY)
+    return ctx->drks;
+#else
+    return ctx->rks;
+#endif
+}
 
-    uint8_t rks[(AES128_ROUNDS + 1) * blocksize] = {0,};
-    aes128_keygen(rks, key);
+static bool check_ctx(const aes_ctx* ctx)
+{
+    if (ctx->cipher == NULL) {
+        Serial.println("context is not initialized");
+        return false;
+    }
+    return true;
+}
 
-    uint8_t keystream[blocksize] = {0};
-    uint8_t ctr_copy[blocksize] = {0};
+void aes_ecb_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ecb_encrypt)(out, in, ctx->rks, length);
+}
 
-    memcpy(ctr_copy, ctr, blocksize);
+void aes_ecb_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
 
-    while (length >= blocksize) {
-        aes128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, blocksize);
-        increase_counter(ctr_copy, blocksize);
+    mode_table_read(ctx->cipher, ecb_decrypt)(out, in, decrypt_rks(ctx), length);
+}
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+void aes_ctr_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    if (!check_ctx(ctx)) {
+        return;
     }
 
-    if (length > 0) {
-        aes128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, length);
+    mode_table_read(ctx->cipher, ctr_encrypt)(out, in, ctx->rks, ctr, length);
+}
+
+void aes_ctr_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    aes_ctr_encrypt_ctx(out, in, ctx, ctr, length);
+}
+
+void aes_cbc_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
     }
+
+    mode_table_read(ctx->cipher, cbc_encrypt)(out, in, ctx->rks, iv, length);
 }
 
-void aes_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+void aes_cbc_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* iv, size_t length)
 {
-    aes_ctr_encrypt(out, in, key, ctr, length);  
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, cbc_decrypt)(out, in, decrypt_rks(ctx), iv, length);
 }
@@ -28,9 +28,58 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#include "aes.h"
 
-void aes_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length);
-void aes_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length);
+struct mode_table;
 
-void aes_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length);
-void aes_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length);
+/**
+ * Keyed context for many messages under one key: aes_ctx_init expands the schedule once and
+ * the _ctx mode functions only do block work. With AES_ON_THE_FLY it keeps the key and the
+ * decryption tail of the schedule instead.
+ *
+ * The arrays are sized for AES-256 whatever the key: on AVR the context takes 242 bytes of
+ * SRAM (176 of the 240 schedule bytes are used by AES-128), or 66 with AES_ON_THE_FLY.
+ */
+struct aes_ctx {
+    const mode_table* cipher;
+#if defined(AES_ON_THE_FLY)
+    uint8_t rks[AES_MAX_KEY_SIZE];
+    uint8_t drks[AES_MAX_KEY_SIZE];
+#else
+    uint8_t rks[AES_MAX_RKS_SIZE];
+#endif
+};
+
+// keysize is the key length in bytes: 16, 24 or 32
+void aes_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length);
+void aes_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length);
+
+void aes_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length);
+void aes_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length);
+
+// out may be in itself, otherwise the two must not overlap
+void aes_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length);
+void aes_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length);
+
+// rks is an encryption schedule in AES_RKS_MEM, e.g. baked with AES128_KEYGEN_CONST from aes_const.h
+void aes_ecb_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length);
+void aes_ecb_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length);
+
+void aes_ctr_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length);
+void aes_ctr_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length);
+
+void aes_cbc_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length);
+void aes_cbc_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length);
+
+// false when keysize is not 16, 24 or 32, the context is then unusable
+bool aes_ctx_init(aes_ctx* ctx, const uint8_t* key, size_t keysize);
+
+void aes_ecb_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, size_t length);
+void aes_ecb_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, size_t length);
+
+void aes_ctr_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* ctr, size_t length);
+void aes_ctr_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* ctr, size_t length);
+
+void aes_cbc_encrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* iv, size_t length);
+void aes_cbc_decrypt_ctx(uint8_t* out, const uint8_t* in, const aes_ctx* ctx, const uint8_t* iv, size_t length);
\ No newline at end of file
@@ -31,8 +31,25 @@
 #include <stddef.h>
 
 void print_hex(const char* title, const uint8_t* data, size_t count);
+void aes_sbox_table_test();
 void aes128_encrypt_test();
 void aes128_decrypt_test();
 void aes128_benchmark();
+void aes_sbox_benchmark();
+void gf256_test();
+void gf256_benchmark();
+void aes192_test();
+void aes256_test();
+void aes_otf_test();
+void aes_const_keygen_test();
+void aes_blob_test();
+void aes128_blob_benchmark();
+void aes128_otf_benchmark();
 void aes128_ecb_test();
-void aes128_ctr_test();
\ No newline at end of file
+void aes128_ctr_test();
+void aes_ctr_cache_test();
+void aes128_ctr_benchmark();
+void aes_ctx_test();
+void aes128_ctx_benchmark();
+void aes_cbc_test();
+void aes128_cbc_benchmark();
\ No newline at end of file
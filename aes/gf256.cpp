@@ -26,66 +26,199 @@
  */
 
 #include "gf256.h"
+#include "HardwareSerial.h"
 
-static uint8_t bitlength(uint16_t value) 
-{
-    uint8_t len = 8;
-    for (int i  = 0; i < 16; ++i) {
-        if ((value & 0x8000) == 0x8000) {
-            break;
-        }
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
-        len -= 1;
-        value <<= 1;
-    }
+#define GF256_MUL2_ENTRY(x) gf256_mul_const(x, 2)
+#define GF256_MUL3_ENTRY(x) gf256_mul_const(x, 3)
+#define GF256_MUL9_ENTRY(x) gf256_mul_const(x, 9)
+#define GF256_MUL11_ENTRY(x) gf256_mul_const(x, 11)
+#define GF256_MUL13_ENTRY(x) gf256_mul_const(x, 13)
+#define GF256_MUL14_ENTRY(x) gf256_mul_const(x, 14)
+
+const uint8_t GF256_MUL2[256] GF256_MEM = { GF256_TABLE(GF256_MUL2_ENTRY) };
+const uint8_t GF256_MUL3[256] GF256_MEM = { GF256_TABLE(GF256_MUL3_ENTRY) };
+const uint8_t GF256_MUL9[256] GF256_MEM = { GF256_TABLE(GF256_MUL9_ENTRY) };
+const uint8_t GF256_MUL11[256] GF256_MEM = { GF256_TABLE(GF256_MUL11_ENTRY) };
+const uint8_t GF256_MUL13[256] GF256_MEM = { GF256_TABLE(GF256_MUL13_ENTRY) };
+const uint8_t GF256_MUL14[256] GF256_MEM = { GF256_TABLE(GF256_MUL14_ENTRY) };
+
+#define GF256_LOG_ENTRY(x) gf256_log_const(x)
+#define GF256_EXP_ENTRY(x) gf256_pow_const(3, (x) % 255)
+#define GF256_EXP_HIGH_ENTRY(x) gf256_pow_const(3, ((x) + 256) % 255)
 
-    return len;
+// EXP is doubled so that LOG[a] + LOG[b] needs no reduction mod 255
+const uint8_t GF256_LOG[256] GF256_MEM = { GF256_TABLE(GF256_LOG_ENTRY) };
+const uint8_t GF256_EXP[512] GF256_MEM = { GF256_TABLE(GF256_EXP_ENTRY), GF256_TABLE(GF256_EXP_HIGH_ENTRY) };
+
+/**
+ * Branch-free: the conditional adds and reductions are masks, so the running time
+ * does not depend on either operand
+ */
+uint8_t gf256_xtime(uint8_t value)
+{
+    return (uint8_t) (value << 1) ^ (0x1b & (uint8_t) -(value >> 7));
 }
 
 uint8_t gf256_mul(uint8_t lhs, uint8_t rhs)
 {
     uint8_t result = 0;
-    uint8_t carry = 0;
 
     for (int i = 0; i < 8; ++i) {
-        if (rhs & 1) {
-            result ^= lhs;
-        }
-        carry = lhs & 0x80;
-        
-        lhs <<= 1;
-        if (carry) {
-            lhs ^= 0x1b;
-        }
-
+        result ^= lhs & (uint8_t) -(rhs & 1);
+        lhs = gf256_xtime(lhs);
         rhs >>= 1;
     }
 
     return result;
 }
 
-uint8_t gf256_inv(uint8_t value)
+uint8_t gf256_mul_log(uint8_t lhs, uint8_t rhs)
+{
+    if (lhs == 0 || rhs == 0) {
+        return 0;
+    }
+
+    return gf256_read(GF256_EXP, gf256_read(GF256_LOG, lhs) + gf256_read(GF256_LOG, rhs));
+}
+
+/**
+ * lo[n] = coef * n and hi[n] = coef * (n << 4), built by linearity from coef * 2^i
+ */
+static void nibble_tables(uint8_t* lo, uint8_t* hi, uint8_t coef)
+{
+    uint8_t basis[8];
+
+    basis[0] = coef;
+    for (int i = 1; i < 8; ++i) {
+        basis[i] = gf256_xtime(basis[i - 1]);
+    }
+
+    lo[0] = 0;
+    hi[0] = 0;
+    for (int n = 1; n < 16; ++n) {
+        int bit = (n & 1) ? 0 : (n & 2) ? 1 : (n & 4) ? 2 : 3;
+        lo[n] = lo[n & (n - 1)] ^ basis[bit];
+        hi[n] = hi[n & (n - 1)] ^ basis[bit + 4];
+    }
+}
+
+static void mul_bulk(uint8_t* out, const uint8_t* in, uint8_t coef, size_t length, bool accumulate)
 {
-    uint16_t u1 = 0, u3 = 0x11b, v1 = 1, v3 = value;
+    uint8_t lo[16];
+    uint8_t hi[16];
+    nibble_tables(lo, hi, coef);
 
-    while (v3 != 0) {
-        uint16_t t1 = u1, t3 = u3;
-        int8_t q = bitlength(u3) - bitlength(v3);
+    size_t i = 0;
 
-        if (q >= 0) {
-            t1 ^= v1 << q;
-            t3 ^= v3 << q;
+#if defined(__SSSE3__)
+    const __m128i table_lo = _mm_loadu_si128((const __m128i*) lo);
+    const __m128i table_hi = _mm_loadu_si128((const __m128i*) hi);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (in + i));
+        __m128i product = _mm_xor_si128(
+            _mm_shuffle_epi8(table_lo, _mm_and_si128(x, nibble)),
+            _mm_shuffle_epi8(table_hi, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+
+        if (accumulate) {
+            product = _mm_xor_si128(product, _mm_loadu_si128((const __m128i*) (out + i)));
         }
+        _mm_storeu_si128((__m128i*) (out + i), product);
+    }
+#endif
 
-        u1 = v1; 
-        u3 = v3;
-        v1 = t1; 
-        v3 = t3;
+    for (; i < length; ++i) {
+        uint8_t product = lo[in[i] & 0x0f] ^ hi[in[i] >> 4];
+        out[i] = accumulate ? out[i] ^ product : product;
     }
+}
 
-    if (u1 >= 0x100) {
-        u1 ^= 0x11b;
+void gf256_mul_bulk(uint8_t* out, const uint8_t* in, uint8_t coef, size_t length)
+{
+    mul_bulk(out, in, coef, length, false);
+}
+
+void gf256_mul_xor_bulk(uint8_t* out, const uint8_t* in, uint8_t coef, size_t length)
+{
+    mul_bulk(out, in, coef, length, true);
+}
+
+static inline uint8_t gf256_square(uint8_t value)
+{
+    return gf256_mul(value, value);
+}
+
+/**
+ * x^254 through a fixed addition chain, 7 squarings and 4 multiplications.
+ * 0 maps to 0, and there is no data-dependent branch or loop bound.
+ */
+uint8_t gf256_inv(uint8_t value)
+{
+    uint8_t x2 = gf256_square(value);
+    uint8_t x3 = gf256_mul(x2, value);
+    uint8_t x12 = gf256_square(gf256_square(x3));
+    uint8_t x15 = gf256_mul(x12, x3);
+    uint8_t x240 = gf256_square(gf256_square(gf256_square(gf256_square(x15))));
+    uint8_t x252 = gf256_mul(x240, x12);
+
+    return gf256_mul(x252, x2);
+}
+
+uint8_t gf256_mul2(uint8_t value)
+{
+    return gf256_read(GF256_MUL2, value);
+}
+
+uint8_t gf256_mul3(uint8_t value)
+{
+    return gf256_read(GF256_MUL3, value);
+}
+
+uint8_t gf256_mul9(uint8_t value)
+{
+    return gf256_read(GF256_MUL9, value);
+}
+
+uint8_t gf256_mul11(uint8_t value)
+{
+    return gf256_read(GF256_MUL11, value);
+}
+
+uint8_t gf256_mul13(uint8_t value)
+{
+    return gf256_read(GF256_MUL13, value);
+}
+
+uint8_t gf256_mul14(uint8_t value)
+{
+    return gf256_read(GF256_MUL14, value);
+}
+
+void gf256_print_table(const char* name, const uint8_t* table)
+{
+    Serial.print("const uint8_t ");
+    Serial.print(name);
+    Serial.println("[] = {");
+
+    for (int i = 0; i < 256; ++i) {
+        uint8_t value = gf256_read(table, i);
+
+        if ((i & 0xf) == 0) {
+            Serial.print("   ");
+        }
+        Serial.print(value < 16 ? " 0x0" : " 0x");
+        Serial.print(value, HEX);
+        Serial.print(",");
+
+        if ((i & 0xf) == 0xf) {
+            Serial.println();
+        }
     }
 
-    return u1;
+    Serial.println("};");
 }
\ No newline at end of file
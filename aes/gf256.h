@@ -28,6 +28,102 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
+/**
+ * Generated tables live in flash on AVR, where 8-bit boards have only a few KB of RAM
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define GF256_MEM PROGMEM
+#define gf256_read(table, index) pgm_read_byte(&(table)[index])
+#else
+#define GF256_MEM
+#define gf256_read(table, index) ((table)[index])
+#endif
+
+/**
+ * Compile-time counterparts of gf256_mul and gf256_inv, used to generate lookup tables.
+ * Written as single-expression recursions so that they stay valid C++11.
+ */
+constexpr uint8_t gf256_xtime_const(uint8_t value)
+{
+    return (uint8_t) ((value << 1) ^ ((value & 0x80) ? 0x1b : 0));
+}
+
+constexpr uint8_t gf256_mul_const(uint8_t lhs, uint8_t rhs)
+{
+    return rhs == 0 ? 0 : (uint8_t) (((rhs & 1) ? lhs : 0) ^ gf256_mul_const(gf256_xtime_const(lhs), rhs >> 1));
+}
+
+constexpr uint8_t gf256_pow_const(uint8_t base, uint8_t exp)
+{
+    return exp == 0 ? 1 : gf256_mul_const((exp & 1) ? base : 1, gf256_pow_const(gf256_mul_const(base, base), exp >> 1));
+}
+
+// x^254 = x^-1 for x != 0, and 0 maps to 0 as in gf256_inv
+constexpr uint8_t gf256_inv_const(uint8_t value)
+{
+    return gf256_pow_const(value, 254);
+}
+
+// discrete logarithm to the base 3, searched from 3^index = power
+constexpr uint8_t gf256_log_const(uint8_t value, uint8_t index = 0, uint8_t power = 1)
+{
+    return (value == 0 || power == value) ? index : gf256_log_const(value, index + 1, gf256_mul_const(power, 3));
+}
+
+/**
+ * Expands to f(0x00), f(0x01), ..., f(0xff) to initialize a 256 entry table at compile time
+ */
+#define GF256_ROW(f, hi) \
+    f(hi + 0x0), f(hi + 0x1), f(hi + 0x2), f(hi + 0x3), f(hi + 0x4), f(hi + 0x5), f(hi + 0x6), f(hi + 0x7), \
+    f(hi + 0x8), f(hi + 0x9), f(hi + 0xa), f(hi + 0xb), f(hi + 0xc), f(hi + 0xd), f(hi + 0xe), f(hi + 0xf)
+
+#define GF256_TABLE(f) \
+    GF256_ROW(f, 0x00), GF256_ROW(f, 0x10), GF256_ROW(f, 0x20), GF256_ROW(f, 0x30), \
+    GF256_ROW(f, 0x40), GF256_ROW(f, 0x50), GF256_ROW(f, 0x60), GF256_ROW(f, 0x70), \
+    GF256_ROW(f, 0x80), GF256_ROW(f, 0x90), GF256_ROW(f, 0xa0), GF256_ROW(f, 0xb0), \
+    GF256_ROW(f, 0xc0), GF256_ROW(f, 0xd0), GF256_ROW(f, 0xe0), GF256_ROW(f, 0xf0)
+
+// multiplication by x, branch-free
+uint8_t gf256_xtime(uint8_t value);
+
+// xtime chain, constant time with no branches or table lookups on the operands
 uint8_t gf256_mul(uint8_t lhs, uint8_t rhs);
-uint8_t gf256_inv(uint8_t value);
\ No newline at end of file
+uint8_t gf256_inv(uint8_t value);
+
+// log/exp tables to the generator 3, faster but the lookups depend on the operands
+uint8_t gf256_mul_log(uint8_t lhs, uint8_t rhs);
+
+/**
+ * Multiplies a whole array by a constant: out = coef * in, or out ^= coef * in for the xor variant.
+ * Both build split-nibble tables for coef once, and use pshufb 16 bytes at a time when
+ * compiled for SSSE3. out and in may be the same array. The table setup is paid on every
+ * call, so this is for long arrays; the block cipher uses the GF256_MULn tables instead.
+ */
+void gf256_mul_bulk(uint8_t* out, const uint8_t* in, uint8_t coef, size_t length);
+void gf256_mul_xor_bulk(uint8_t* out, const uint8_t* in, uint8_t coef, size_t length);
+
+/**
+ * Table lookups for multiplication by the MixColumns and InvMixColumns coefficients
+ */
+uint8_t gf256_mul2(uint8_t value);
+uint8_t gf256_mul3(uint8_t value);
+uint8_t gf256_mul9(uint8_t value);
+uint8_t gf256_mul11(uint8_t value);
+uint8_t gf256_mul13(uint8_t value);
+uint8_t gf256_mul14(uint8_t value);
+
+// prints a generated table as a C array
+void gf256_print_table(const char* name, const uint8_t* table);
+
+extern const uint8_t GF256_MUL2[256];
+extern const uint8_t GF256_MUL3[256];
+extern const uint8_t GF256_MUL9[256];
+extern const uint8_t GF256_MUL11[256];
+extern const uint8_t GF256_MUL13[256];
+extern const uint8_t GF256_MUL14[256];
+
+extern const uint8_t GF256_LOG[256];
+extern const uint8_t GF256_EXP[512];
\ No newline at end of file
@@ -25,50 +25,104 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include <stdio.h>
 #include <stdint.h>
 #include "sbox.h"
 #include "gf256.h"
 
-const uint8_t SBOX_COEF[] = {
+static constexpr uint8_t SBOX_COEF[] = {
     0xf1, 0xe3, 0xc7, 0x8f, 0x1f, 0x3e, 0x7c, 0xf8, 
 };
 
-const uint8_t SINV_COEF[] = {
+static constexpr uint8_t SINV_COEF[] = {
     0xa4, 0x49, 0x92, 0x25, 0x4a, 0x94, 0x29, 0x52, 
 };
 
+static constexpr uint8_t parity(uint8_t value)
+{
+    return value == 0 ? 0 : (uint8_t) ((value & 1) ^ parity(value >> 1));
+}
+
+/**
+ * Bit i of the result is the parity of input & coef[i], for rows i .. 7
+ */
+static constexpr uint8_t affine(uint8_t input, const uint8_t* coef, int i)
+{
+    return i == 8 ? 0 : (uint8_t) ((parity(input & coef[i]) << i) ^ affine(input, coef, i + 1));
+}
+
+static constexpr uint8_t sbox_const(uint8_t input)
+{
+    return affine(gf256_inv_const(input), SBOX_COEF, 0) ^ 0x63;
+}
+
+static constexpr uint8_t sinv_const(uint8_t input)
+{
+    return gf256_inv_const(affine(input, SINV_COEF, 0) ^ 0x05);
+}
+
+#define SBOX_ENTRY(x) sbox_const(x)
+#define SINV_ENTRY(x) sinv_const(x)
+
+/**
+ * Evaluated by the compiler from the inversion and affine transform above
+ */
+const uint8_t SBOX[256] GF256_MEM = { GF256_TABLE(SBOX_ENTRY) };
+const uint8_t SINV[256] GF256_MEM = { GF256_TABLE(SINV_ENTRY) };
+
+static inline uint8_t rot8l(uint8_t value, int shift)
+{
+    return (uint8_t) ((value << shift) | (value >> (8 - shift)));
+}
+
+/**
+ * The affine rows SBOX_COEF/SINV_COEF are rotations of one another, so each
+ * transform is a sum of rotations of its input
+ */
+uint8_t affine_sbox_ct(uint8_t input)
+{
+    uint8_t inv = gf256_inv(input);
+    return inv ^ rot8l(inv, 1) ^ rot8l(inv, 2) ^ rot8l(inv, 3) ^ rot8l(inv, 4) ^ 0x63;
+}
+
+uint8_t affine_sinv_ct(uint8_t input)
+{
+    return gf256_inv(rot8l(input, 1) ^ rot8l(input, 3) ^ rot8l(input, 6) ^ 0x05);
+}
+
+#if defined(AES_SBOX_CONSTANT_TIME)
+
 uint8_t affine_sbox(uint8_t input)
 {
-    uint8_t result = 0;
-    input = gf256_inv(input);
-    for (int i = 0; i < 8; ++i) {
-        uint8_t row = input & SBOX_COEF[i];
-        uint8_t bit = 0;
-        for (int j = 0; j < 8; ++j) {
-            bit ^= (row & 0x1);
-            row >>= 1;
-        }
-
-        result ^= (bit << i);
-    }
-
-    return result ^ 0x63;
+    return affine_sbox_ct(input);
 }
 
 uint8_t affine_sinv(uint8_t input)
 {
-    uint8_t result = 0;    
-    for (int i = 0; i < 8; ++i) {
-        uint8_t row = input & SINV_COEF[i];
-        uint8_t bit = 0;
-        for (int j = 0; j < 8; ++j) {
-            bit ^= (row & 0x1);
-            row >>= 1;
-        }
-
-        result ^= (bit << i);
-    }
-
-    return gf256_inv(result ^ 0x05);
+    return affine_sinv_ct(input);
+}
+
+#else
+
+uint8_t affine_sbox(uint8_t input)
+{
+    return gf256_read(SBOX, input);
+}
+
+uint8_t affine_sinv(uint8_t input)
+{
+    return gf256_read(SINV, input);
+}
+
+#endif
+
+void print_sbox_tables()
+{
+    gf256_print_table("SBOX", SBOX);
+    gf256_print_table("SINV", SINV);
+    gf256_print_table("GF256_MUL2", GF256_MUL2);
+    gf256_print_table("GF256_MUL3", GF256_MUL3);
+    gf256_print_table("GF256_MUL9", GF256_MUL9);
+    gf256_print_table("GF256_MUL11", GF256_MUL11);
+    gf256_print_table("GF256_MUL13", GF256_MUL13);
+    gf256_print_table("GF256_MUL14", GF256_MUL14);
 }
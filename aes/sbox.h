@@ -29,7 +29,21 @@
 
 #include <stdint.h>
 
+extern const uint8_t SBOX[256];
+extern const uint8_t SINV[256];
+
+/**
+ * affine_sbox and affine_sinv read the generated tables by default. Define AES_SBOX_CONSTANT_TIME
+ * to compute them instead, for targets that cannot spare the tables or must not leak
+ * through table access timing. The same macro makes the reference cipher compute MixColumns
+ * and its inverse with gf256_xtime rather than the GF256_MULn tables, so no table is indexed
+ * by the state.
+ */
 uint8_t affine_sbox(uint8_t input);
 uint8_t affine_sinv(uint8_t input);
 
+// computed with gf256_inv and the affine transform, constant time
+uint8_t affine_sbox_ct(uint8_t input);
+uint8_t affine_sinv_ct(uint8_t input);
+
 void print_sbox_tables();
\ No newline at end of file
@@ -0,0 +1,620 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "aes.h"
+
+/**
+ * Bitsliced AES-128. Four blocks are packed into eight 64-bit words so that
+ * q[i] holds bit i of all 64 state bytes, and every operation is a fixed
+ * sequence of logical instructions with no secret-dependent memory access.
+ * The 8-block kernels run two such 4-block slices side by side.
+ */
+
+static const uint32_t RC[] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
+};
+
+static inline uint32_t load32(const uint8_t* in)
+{
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+static inline void store32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+}
+
+static inline void swapn(uint64_t* x, uint64_t* y, uint64_t cl, uint64_t ch, int s)
+{
+    uint64_t a = *x;
+    uint64_t b = *y;
+
+    *x = (a & cl) | ((b & cl) << s);
+    *y = ((a & ch) >> s) | (b & ch);
+}
+
+/**
+ * Transposes between the interleaved byte layout and the bitsliced layout, it is its own inverse
+ */
+static void ortho(uint64_t* q)
+{
+    swapn(&q[0], &q[1], 0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1);
+    swapn(&q[2], &q[3], 0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1);
+    swapn(&q[4], &q[5], 0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1);
+    swapn(&q[6], &q[7], 0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1);
+
+    swapn(&q[0], &q[2], 0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2);
+    swapn(&q[1], &q[3], 0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2);
+    swapn(&q[4], &q[6], 0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2);
+    swapn(&q[5], &q[7], 0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2);
+
+    swapn(&q[0], &q[4], 0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4);
+    swapn(&q[1], &q[5], 0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4);
+    swapn(&q[2], &q[6], 0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4);
+    swapn(&q[3], &q[7], 0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4);
+}
+
+/**
+ * Spreads the four 32-bit words of one block over two 64-bit words, 16 bits per row
+ */
+static void interleave_in(uint64_t* q0, uint64_t* q1, const uint32_t* w)
+{
+    uint64_t x0 = w[0];
+    uint64_t x1 = w[1];
+    uint64_t x2 = w[2];
+    uint64_t x3 = w[3];
+
+    x0 |= (x0 << 16);
+    x1 |= (x1 << 16);
+    x2 |= (x2 << 16);
+    x3 |= (x3 << 16);
+    x0 &= 0x0000FFFF0000FFFF;
+    x1 &= 0x0000FFFF0000FFFF;
+    x2 &= 0x0000FFFF0000FFFF;
+    x3 &= 0x0000FFFF0000FFFF;
+    x0 |= (x0 << 8);
+    x1 |= (x1 << 8);
+    x2 |= (x2 << 8);
+    x3 |= (x3 << 8);
+    x0 &= 0x00FF00FF00FF00FF;
+    x1 &= 0x00FF00FF00FF00FF;
+    x2 &= 0x00FF00FF00FF00FF;
+    x3 &= 0x00FF00FF00FF00FF;
+
+    *q0 = x0 | (x2 << 8);
+    *q1 = x1 | (x3 << 8);
+}
+
+static void interleave_out(uint32_t* w, uint64_t q0, uint64_t q1)
+{
+    uint64_t x0 = q0 & 0x00FF00FF00FF00FF;
+    uint64_t x1 = q1 & 0x00FF00FF00FF00FF;
+    uint64_t x2 = (q0 >> 8) & 0x00FF00FF00FF00FF;
+    uint64_t x3 = (q1 >> 8) & 0x00FF00FF00FF00FF;
+
+    x0 |= (x0 >> 8);
+    x1 |= (x1 >> 8);
+    x2 |= (x2 >> 8);
+    x3 |= (x3 >> 8);
+    x0 &= 0x0000FFFF0000FFFF;
+    x1 &= 0x0000FFFF0000FFFF;
+    x2 &= 0x0000FFFF0000FFFF;
+    x3 &= 0x0000FFFF0000FFFF;
+
+    w[0] = (uint32_t) x0 | (uint32_t) (x0 >> 16);
+    w[1] = (uint32_t) x1 | (uint32_t) (x1 >> 16);
+    w[2] = (uint32_t) x2 | (uint32_t) (x2 >> 16);
+    w[3] = (uint32_t) x3 | (uint32_t) (x3 >> 16);
+}
+
+/**
+ * Loads up to four blocks into one slice, missing blocks are zero
+ */
+static void load_blocks(uint64_t* q, const uint8_t* in, size_t count)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        uint32_t w[4] = {0,};
+
+        if (i < count) {
+            w[0] = load32(in + 16 * i);
+            w[1] = load32(in + 16 * i + 4);
+            w[2] = load32(in + 16 * i + 8);
+            w[3] = load32(in + 16 * i + 12);
+        }
+
+        interleave_in(&q[i], &q[i + 4], w);
+    }
+
+    ortho(q);
+}
+
+static void store_blocks(uint8_t* out, uint64_t* q, size_t count)
+{
+    ortho(q);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t w[4];
+        interleave_out(w, q[i], q[i + 4]);
+
+        store32(out + 16 * i, w[0]);
+        store32(out + 16 * i + 4, w[1]);
+        store32(out + 16 * i + 8, w[2]);
+        store32(out + 16 * i + 12, w[3]);
+    }
+}
+
+/**
+ * Boyar-Peralta S-box circuit, 113 gates: x0 is the most significant bit
+ */
+static void sub_bytes(uint64_t* q)
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    // top linear transformation
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    // non-linear section
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    // bottom linear transformation
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/**
+ * Applies y -> A^-1(y ^ 0x63), where A is the S-box affine map
+ */
+static void inv_affine(uint64_t* q)
+{
+    uint64_t q0 = ~q[0];
+    uint64_t q1 = ~q[1];
+    uint64_t q2 = q[2];
+    uint64_t q3 = q[3];
+    uint64_t q4 = q[4];
+    uint64_t q5 = ~q[5];
+    uint64_t q6 = ~q[6];
+    uint64_t q7 = q[7];
+
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+/**
+ * S^-1(y) = inv(A^-1(y ^ 0x63)) and inv(x) = A^-1(S(x) ^ 0x63), so the forward circuit is reused
+ */
+static void inv_sub_bytes(uint64_t* q)
+{
+    inv_affine(q);
+    sub_bytes(q);
+    inv_affine(q);
+}
+
+static inline uint64_t rot64r16(uint64_t value)
+{
+    return (value >> 16) | (value << 48);
+}
+
+static inline uint64_t rot64r32(uint64_t value)
+{
+    return (value >> 32) | (value << 32);
+}
+
+/**
+ * Each 16-bit quarter of a word is one row (four columns of four blocks), so a row rotation is a masked shift
+ */
+static void shift_rows(uint64_t* q)
+{
+    for (int i = 0; i < 8; ++i) {
+        uint64_t x = q[i];
+
+        q[i] = (x & 0x000000000000FFFF)
+            | ((x & 0x00000000FFF00000) >> 4)
+            | ((x & 0x00000000000F0000) << 12)
+            | ((x & 0x0000FF0000000000) >> 8)
+            | ((x & 0x000000FF00000000) << 8)
+            | ((x & 0xF000000000000000) >> 12)
+            | ((x & 0x0FFF000000000000) << 4);
+    }
+}
+
+static void inv_shift_rows(uint64_t* q)
+{
+    for (int i = 0; i < 8; ++i) {
+        uint64_t x = q[i];
+
+        q[i] = (x & 0x000000000000FFFF)
+            | ((x & 0x000000000FFF0000) << 4)
+            | ((x & 0x00000000F0000000) >> 12)
+            | ((x & 0x000000FF00000000) << 8)
+            | ((x & 0x0000FF0000000000) >> 8)
+            | ((x & 0x000F000000000000) << 12)
+            | ((x & 0xFFF0000000000000) >> 4);
+    }
+}
+
+/**
+ * Rotating by 16 bits moves every byte to the next row of its column, q[0] is the least significant bit
+ */
+static void mix_columns(uint64_t* q)
+{
+    uint64_t q0 = q[0];
+    uint64_t q1 = q[1];
+    uint64_t q2 = q[2];
+    uint64_t q3 = q[3];
+    uint64_t q4 = q[4];
+    uint64_t q5 = q[5];
+    uint64_t q6 = q[6];
+    uint64_t q7 = q[7];
+
+    uint64_t r0 = rot64r16(q0);
+    uint64_t r1 = rot64r16(q1);
+    uint64_t r2 = rot64r16(q2);
+    uint64_t r3 = rot64r16(q3);
+    uint64_t r4 = rot64r16(q4);
+    uint64_t r5 = rot64r16(q5);
+    uint64_t r6 = rot64r16(q6);
+    uint64_t r7 = rot64r16(q7);
+
+    q[0] = q7 ^ r7 ^ r0 ^ rot64r32(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rot64r32(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ rot64r32(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rot64r32(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rot64r32(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ rot64r32(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ rot64r32(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ rot64r32(q7 ^ r7);
+}
+
+/**
+ * InvMixColumns = MixColumns after a ^= {04} * (a ^ a rotated by two rows)
+ */
+static void inv_mix_columns(uint64_t* q)
+{
+    uint64_t t[8];
+
+    for (int i = 0; i < 8; ++i) {
+        t[i] = q[i] ^ rot64r32(q[i]);
+    }
+
+    // two xtime steps on bit planes, 0x1b feeds bits 0, 1, 3 and 4
+    uint64_t c0 = t[7];
+    uint64_t c1 = t[6];
+
+    q[0] ^= c1;
+    q[1] ^= c0 ^ c1;
+    q[2] ^= t[0] ^ c0;
+    q[3] ^= t[1] ^ c1;
+    q[4] ^= t[2] ^ c0 ^ c1;
+    q[5] ^= t[3] ^ c0;
+    q[6] ^= t[4];
+    q[7] ^= t[5];
+
+    mix_columns(q);
+}
+
+static inline void add_round_key(uint64_t* q, const uint64_t* rk)
+{
+    for (int i = 0; i < 8; ++i) {
+        q[i] ^= rk[i];
+    }
+}
+
+static void encrypt_slices(uint64_t* q, size_t slices, const uint64_t* rk, size_t rounds)
+{
+    for (size_t s = 0; s < slices; ++s) {
+        add_round_key(q + 8 * s, rk);
+    }
+
+    for (size_t round = 1; round < rounds; ++round) {
+        rk += 8;
+
+        for (size_t s = 0; s < slices; ++s) {
+            sub_bytes(q + 8 * s);
+            shift_rows(q + 8 * s);
+            mix_columns(q + 8 * s);
+            add_round_key(q + 8 * s, rk);
+        }
+    }
+
+    rk += 8;
+
+    for (size_t s = 0; s < slices; ++s) {
+        sub_bytes(q + 8 * s);
+        shift_rows(q + 8 * s);
+        add_round_key(q + 8 * s, rk);
+    }
+}
+
+static void decrypt_slices(uint64_t* q, size_t slices, const uint64_t* rk, size_t rounds)
+{
+    rk += 8 * rounds;
+
+    for (size_t s = 0; s < slices; ++s) {
+        add_round_key(q + 8 * s, rk);
+    }
+
+    for (size_t round = 1; round < rounds; ++round) {
+        rk -= 8;
+
+        for (size_t s = 0; s < slices; ++s) {
+            inv_shift_rows(q + 8 * s);
+            inv_sub_bytes(q + 8 * s);
+            add_round_key(q + 8 * s, rk);
+            inv_mix_columns(q + 8 * s);
+        }
+    }
+
+    rk -= 8;
+
+    for (size_t s = 0; s < slices; ++s) {
+        inv_shift_rows(q + 8 * s);
+        inv_sub_bytes(q + 8 * s);
+        add_round_key(q + 8 * s, rk);
+    }
+}
+
+static uint32_t sub_word(uint32_t value)
+{
+    uint64_t q[8] = {0,};
+
+    q[0] = value;
+    ortho(q);
+    sub_bytes(q);
+    ortho(q);
+
+    return (uint32_t) q[0];
+}
+
+static inline uint32_t rot32r8(uint32_t value)
+{
+    return (value >> 8) ^ (value << 24);
+}
+
+/**
+ * Expands the key and stores every round key already bitsliced, replicated over the four blocks of a slice
+ */
+void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    uint64_t* rk = (uint64_t*) rks;
+    uint32_t w[4 * (AES128_ROUNDS + 1)];
+
+    for (int i = 0; i < 4; ++i) {
+        w[i] = load32(mk + 4 * i);
+    }
+
+    for (int i = 0; i < AES128_ROUNDS; ++i) {
+        uint32_t* k = w + 4 * i;
+
+        k[4] = k[0] ^ sub_word(rot32r8(k[3])) ^ RC[i];
+        k[5] = k[1] ^ k[4];
+        k[6] = k[2] ^ k[5];
+        k[7] = k[3] ^ k[6];
+    }
+
+    for (int i = 0; i <= AES128_ROUNDS; ++i, rk += 8) {
+        for (int j = 0; j < 4; ++j) {
+            interleave_in(&rk[j], &rk[j + 4], w + 4 * i);
+        }
+        ortho(rk);
+    }
+
+    memset(w, 0, sizeof(w));
+}
+
+void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    uint64_t q[8];
+
+    load_blocks(q, pt, 1);
+    encrypt_slices(q, 1, (const uint64_t*) rks, AES128_ROUNDS);
+    store_blocks(ct, q, 1);
+}
+
+void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    uint64_t q[8];
+
+    load_blocks(q, ct, 1);
+    decrypt_slices(q, 1, (const uint64_t*) rks, AES128_ROUNDS);
+    store_blocks(pt, q, 1);
+}
+
+void aes128_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    uint64_t q[16];
+
+    load_blocks(q, pt, 4);
+    load_blocks(q + 8, pt + 64, 4);
+    encrypt_slices(q, 2, (const uint64_t*) rks, AES128_ROUNDS);
+    store_blocks(ct, q, 4);
+    store_blocks(ct + 64, q + 8, 4);
+}
+
+void aes128_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    uint64_t q[16];
+
+    load_blocks(q, ct, 4);
+    load_blocks(q + 8, ct + 64, 4);
+    decrypt_slices(q, 2, (const uint64_t*) rks, AES128_ROUNDS);
+    store_blocks(pt, q, 4);
+    store_blocks(pt + 64, q + 8, 4);
+}
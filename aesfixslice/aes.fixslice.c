@@ -0,0 +1,538 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "aes.h"
+
+/**
+ * Fixsliced AES-128 in plain C. Two blocks are packed into eight 32-bit words,
+ * q[i] holds bit i of all 32 state bytes: byte r of a word is row r, and each
+ * row byte keeps two bits (one per block) for every column.
+ *
+ * ShiftRows is never applied to the state. After round i the stored state S
+ * relates to the true state T by T = SR^i(S), so MixColumns of round i reads
+ * its column from the diagonal shifted by i mod 4 and the round keys are
+ * stored as SR^-i(K_i). SR^10 = SR^2 is undone once after the last round.
+ */
+
+static const uint32_t RC[] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
+};
+
+static uint32_t load32(const uint8_t* in)
+{
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+static void store32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+}
+
+static void swapn(uint32_t* x, uint32_t* y, uint32_t cl, uint32_t ch, int s)
+{
+    uint32_t a = *x;
+    uint32_t b = *y;
+
+    *x = (a & cl) | ((b & cl) << s);
+    *y = ((a & ch) >> s) | (b & ch);
+}
+
+/**
+ * Transposes between the packed byte layout and the bitsliced layout, it is its own inverse
+ */
+static void ortho(uint32_t* q)
+{
+    swapn(&q[0], &q[1], 0x55555555, 0xAAAAAAAA, 1);
+    swapn(&q[2], &q[3], 0x55555555, 0xAAAAAAAA, 1);
+    swapn(&q[4], &q[5], 0x55555555, 0xAAAAAAAA, 1);
+    swapn(&q[6], &q[7], 0x55555555, 0xAAAAAAAA, 1);
+
+    swapn(&q[0], &q[2], 0x33333333, 0xCCCCCCCC, 2);
+    swapn(&q[1], &q[3], 0x33333333, 0xCCCCCCCC, 2);
+    swapn(&q[4], &q[6], 0x33333333, 0xCCCCCCCC, 2);
+    swapn(&q[5], &q[7], 0x33333333, 0xCCCCCCCC, 2);
+
+    swapn(&q[0], &q[4], 0x0F0F0F0F, 0xF0F0F0F0, 4);
+    swapn(&q[1], &q[5], 0x0F0F0F0F, 0xF0F0F0F0, 4);
+    swapn(&q[2], &q[6], 0x0F0F0F0F, 0xF0F0F0F0, 4);
+    swapn(&q[3], &q[7], 0x0F0F0F0F, 0xF0F0F0F0, 4);
+}
+
+static void load_blocks(uint32_t* q, const uint8_t* in0, const uint8_t* in1)
+{
+    for (int i = 0; i < 4; ++i) {
+        q[2 * i] = load32(in0 + 4 * i);
+        q[2 * i + 1] = in1 ? load32(in1 + 4 * i) : 0;
+    }
+
+    ortho(q);
+}
+
+static void store_blocks(uint8_t* out0, uint8_t* out1, uint32_t* q)
+{
+    ortho(q);
+
+    for (int i = 0; i < 4; ++i) {
+        store32(out0 + 4 * i, q[2 * i]);
+        if (out1) {
+            store32(out1 + 4 * i, q[2 * i + 1]);
+        }
+    }
+}
+
+/**
+ * Boyar-Peralta S-box circuit, 113 gates: x0 is the most significant bit
+ */
+static void sub_bytes(uint32_t* q)
+{
+    uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint32_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint32_t y20, y21;
+    uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint32_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint32_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint32_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint32_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint32_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint32_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint32_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint32_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    /* top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* non-linear section */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* bottom linear transformation */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/**
+ * Applies y -> A^-1(y ^ 0x63), where A is the S-box affine map
+ */
+static void inv_affine(uint32_t* q)
+{
+    uint32_t q0 = ~q[0];
+    uint32_t q1 = ~q[1];
+    uint32_t q2 = q[2];
+    uint32_t q3 = q[3];
+    uint32_t q4 = q[4];
+    uint32_t q5 = ~q[5];
+    uint32_t q6 = ~q[6];
+    uint32_t q7 = q[7];
+
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+static void inv_sub_bytes(uint32_t* q)
+{
+    inv_affine(q);
+    sub_bytes(q);
+    inv_affine(q);
+}
+
+static uint32_t rot32r8(uint32_t value)
+{
+    return (value >> 8) | (value << 24);
+}
+
+static uint32_t rot32r16(uint32_t value)
+{
+    return (value >> 16) | (value << 16);
+}
+
+/**
+ * Moves every row byte by 'cols' columns towards column 0, the same amount in every row
+ */
+static uint32_t rotate_columns(uint32_t value, int cols)
+{
+    switch (cols & 3) {
+    case 1:
+        return ((value >> 2) & 0x3F3F3F3F) | ((value << 6) & 0xC0C0C0C0);
+    case 2:
+        return ((value >> 4) & 0x0F0F0F0F) | ((value << 4) & 0xF0F0F0F0);
+    case 3:
+        return ((value >> 6) & 0x03030303) | ((value << 2) & 0xFCFCFCFC);
+    default:
+        return value;
+    }
+}
+
+/**
+ * SR^n, row r rotated by n * r columns
+ */
+static void shift_rows_n(uint32_t* q, int n)
+{
+    for (int i = 0; i < 8; ++i) {
+        uint32_t x = q[i];
+        q[i] = (x & 0x000000FF)
+            | (rotate_columns(x, n) & 0x0000FF00)
+            | (rotate_columns(x, 2 * n) & 0x00FF0000)
+            | (rotate_columns(x, 3 * n) & 0xFF000000);
+    }
+}
+
+/**
+ * MixColumns on a state that still owes SR^shift: the row below sits 'shift' columns further
+ * and the rows two below sit 2 * 'shift' columns further, so both rotations pick up a column offset
+ */
+static void mix_columns(uint32_t* q, int shift)
+{
+    uint32_t q0 = q[0];
+    uint32_t q1 = q[1];
+    uint32_t q2 = q[2];
+    uint32_t q3 = q[3];
+    uint32_t q4 = q[4];
+    uint32_t q5 = q[5];
+    uint32_t q6 = q[6];
+    uint32_t q7 = q[7];
+
+    uint32_t r0 = rotate_columns(rot32r8(q0), shift);
+    uint32_t r1 = rotate_columns(rot32r8(q1), shift);
+    uint32_t r2 = rotate_columns(rot32r8(q2), shift);
+    uint32_t r3 = rotate_columns(rot32r8(q3), shift);
+    uint32_t r4 = rotate_columns(rot32r8(q4), shift);
+    uint32_t r5 = rotate_columns(rot32r8(q5), shift);
+    uint32_t r6 = rotate_columns(rot32r8(q6), shift);
+    uint32_t r7 = rotate_columns(rot32r8(q7), shift);
+
+    int shift2 = 2 * shift;
+
+    q[0] = q7 ^ r7 ^ r0 ^ rotate_columns(rot32r16(q0 ^ r0), shift2);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotate_columns(rot32r16(q1 ^ r1), shift2);
+    q[2] = q1 ^ r1 ^ r2 ^ rotate_columns(rot32r16(q2 ^ r2), shift2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotate_columns(rot32r16(q3 ^ r3), shift2);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotate_columns(rot32r16(q4 ^ r4), shift2);
+    q[5] = q4 ^ r4 ^ r5 ^ rotate_columns(rot32r16(q5 ^ r5), shift2);
+    q[6] = q5 ^ r5 ^ r6 ^ rotate_columns(rot32r16(q6 ^ r6), shift2);
+    q[7] = q6 ^ r6 ^ r7 ^ rotate_columns(rot32r16(q7 ^ r7), shift2);
+}
+
+/**
+ * InvMixColumns = MixColumns after a ^= {04} * (a ^ a two rows below), with the same column offsets
+ */
+static void inv_mix_columns(uint32_t* q, int shift)
+{
+    uint32_t t[8];
+
+    for (int i = 0; i < 8; ++i) {
+        t[i] = q[i] ^ rotate_columns(rot32r16(q[i]), 2 * shift);
+    }
+
+    /* two xtime steps on bit planes, 0x1b feeds bits 0, 1, 3 and 4 */
+    uint32_t c0 = t[7];
+    uint32_t c1 = t[6];
+
+    q[0] ^= c1;
+    q[1] ^= c0 ^ c1;
+    q[2] ^= t[0] ^ c0;
+    q[3] ^= t[1] ^ c1;
+    q[4] ^= t[2] ^ c0 ^ c1;
+    q[5] ^= t[3] ^ c0;
+    q[6] ^= t[4];
+    q[7] ^= t[5];
+
+    mix_columns(q, shift);
+}
+
+static void add_round_key(uint32_t* q, const uint32_t* rk)
+{
+    for (int i = 0; i < 8; ++i) {
+        q[i] ^= rk[i];
+    }
+}
+
+/**
+ * Rounds 1..9 run MixColumns with offsets 1, 2, 3, 0, 1, 2, 3, 0, 1
+ */
+static void encrypt_fixsliced(uint32_t* q, const uint32_t* rk)
+{
+    add_round_key(q, rk);
+
+    for (int round = 1; round < AES128_ROUNDS; ++round) {
+        rk += 8;
+
+        sub_bytes(q);
+        mix_columns(q, round & 3);
+        add_round_key(q, rk);
+    }
+
+    rk += 8;
+
+    sub_bytes(q);
+    add_round_key(q, rk);
+    shift_rows_n(q, AES128_ROUNDS & 3);
+}
+
+static void decrypt_fixsliced(uint32_t* q, const uint32_t* rk)
+{
+    rk += 8 * AES128_ROUNDS;
+
+    shift_rows_n(q, -AES128_ROUNDS & 3);
+    add_round_key(q, rk);
+    inv_sub_bytes(q);
+
+    for (int round = AES128_ROUNDS - 1; round > 0; --round) {
+        rk -= 8;
+
+        add_round_key(q, rk);
+        inv_mix_columns(q, round & 3);
+        inv_sub_bytes(q);
+    }
+
+    rk -= 8;
+
+    add_round_key(q, rk);
+}
+
+static uint32_t sub_word(uint32_t value)
+{
+    uint32_t q[8] = {0,};
+
+    q[0] = value;
+    ortho(q);
+    sub_bytes(q);
+    ortho(q);
+
+    return q[0];
+}
+
+/**
+ * Stores round key i bitsliced for both blocks, already moved by SR^-i
+ */
+void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    uint32_t* rk = (uint32_t*) rks;
+    uint32_t w[4 * (AES128_ROUNDS + 1)];
+
+    for (int i = 0; i < 4; ++i) {
+        w[i] = load32(mk + 4 * i);
+    }
+
+    for (int i = 0; i < AES128_ROUNDS; ++i) {
+        uint32_t* k = w + 4 * i;
+
+        k[4] = k[0] ^ sub_word(rot32r8(k[3])) ^ RC[i];
+        k[5] = k[1] ^ k[4];
+        k[6] = k[2] ^ k[5];
+        k[7] = k[3] ^ k[6];
+    }
+
+    for (int i = 0; i <= AES128_ROUNDS; ++i, rk += 8) {
+        for (int j = 0; j < 4; ++j) {
+            rk[2 * j] = w[4 * i + j];
+            rk[2 * j + 1] = w[4 * i + j];
+        }
+
+        ortho(rk);
+        shift_rows_n(rk, -i & 3);
+    }
+
+    memset(w, 0, sizeof(w));
+}
+
+void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    uint32_t q[8];
+
+    load_blocks(q, pt, NULL);
+    encrypt_fixsliced(q, (const uint32_t*) rks);
+    store_blocks(ct, NULL, q);
+}
+
+void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    uint32_t q[8];
+
+    load_blocks(q, ct, NULL);
+    decrypt_fixsliced(q, (const uint32_t*) rks);
+    store_blocks(pt, NULL, q);
+}
+
+void aes128_encrypt2(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    uint32_t q[8];
+
+    load_blocks(q, pt, pt + 16);
+    encrypt_fixsliced(q, (const uint32_t*) rks);
+    store_blocks(ct, ct + 16, q);
+}
+
+void aes128_decrypt2(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    uint32_t q[8];
+
+    load_blocks(q, ct, ct + 16);
+    decrypt_fixsliced(q, (const uint32_t*) rks);
+    store_blocks(pt, pt + 16, q);
+}
@@ -0,0 +1,54 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2018 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define AES128_ROUNDS 10
+
+// round keys are stored fixsliced: eight 32-bit words per round
+#define AES128_RKS_SIZE ((AES128_ROUNDS + 1) * 32)
+
+// blocks processed by one call to the multi-block kernels
+#define AES_FIXSLICE_BLOCKS 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void aes128_keygen(uint8_t* rks, const uint8_t* mk);
+void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+
+void aes128_encrypt2(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+void aes128_decrypt2(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "aes.h"
+#include "aes_mode.h"
+#include <block_mode.h>
+#include "HardwareSerial.h"
+
+// ECB runs and CTR counter blocks go through the AES_FIXSLICE_BLOCKS-block kernels, the rest one block at a time
+typedef mode_cipher<16, AES128_RKS_SIZE, AES128_RKS_SIZE, aes128_keygen, aes128_keygen, aes128_encrypt, aes128_decrypt,
+                    mode_no_ctr, mode_bulk_kernel<AES_FIXSLICE_BLOCKS, aes128_encrypt2, aes128_decrypt2> > AES128;
+
+static bool check_length(size_t length)
+{
+    if (length % 16 != 0) {
+        Serial.println("length is not multiple of 16");
+        return false;
+    }
+    return true;
+}
+
+void aes_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    mode_ecb_encrypt_key<AES128>(out, in, key, length);
+}
+
+void aes_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    mode_ecb_decrypt_key<AES128>(out, in, key, length);
+}
+
+void aes_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+{
+    mode_ctr_encrypt_key<AES128>(out, in, key, ctr, length);
+}
+
+void aes_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+{
+    aes_ctr_encrypt(out, in, key, ctr, length);
+}
@@ -0,0 +1,264 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "aes_test.h"
+#include "aes.h"
+#include "aes_mode.h"
+#include "Arduino.h"
+
+static const size_t RKS_SIZE = AES128_RKS_SIZE;
+
+void print_hex(const char* title, const uint8_t* data, size_t count)
+{
+    Serial.println(title);
+    for (size_t i = 0; i < count; ++i) {
+        if (data[i] < 16) {
+          Serial.print("0");
+        }
+        Serial.print(data[i], HEX);
+
+        if (((i+1) & 0xf) == 0) {
+            Serial.println();
+        } else if ( ((i+1) & 0x3) == 0) {
+            Serial.print(" ");
+        }
+    }
+
+    if ( (count & 0xf) != 0) {
+        Serial.println();
+    }    
+}
+
+static void compare_block(const char* title, const uint8_t* lhs, const uint8_t* rhs)
+{
+    int out = memcmp(lhs, rhs, 16);
+
+    Serial.println(title);
+    print_hex("In ", lhs, 16);
+    print_hex("Out", rhs, 16);
+
+    if (out == 0) {
+        Serial.println("passed");
+    } else {
+        Serial.println("failed");
+    }
+
+    Serial.println();
+}
+
+void aes128_benchmark()
+{
+    uint8_t mk[16] = {0};
+    uint8_t pt[16] = {0};
+    uint8_t enc[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    long start = micros();
+
+    aes128_encrypt(enc, pt, rks);
+
+    long elapsed = micros() - start;
+
+    Serial.print("Elapsed time for AES-128 1 block encryption: ");
+    Serial.println(elapsed);
+
+    delay(1000);
+}
+
+void aes128_fixslice_benchmark()
+{
+    const size_t length = 4096;
+    static uint8_t buffer[length];
+
+    uint8_t mk[16] = {0};
+    uint8_t ctr[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    long start = micros();
+    for (size_t i = 0; i < length; i += 16) {
+        aes128_encrypt(buffer + i, buffer + i, rks);
+    }
+    long elapsed_single = micros() - start;
+
+    start = micros();
+    aes_ctr_encrypt(buffer, buffer, mk, ctr, length);
+    long elapsed_ctr = micros() - start;
+
+    Serial.print("Elapsed time for AES-128 4096 bytes, single block kernel: ");
+    Serial.println(elapsed_single);
+    Serial.print("Elapsed time for AES-128 4096 bytes CTR, 2 block kernel: ");
+    Serial.println(elapsed_ctr);
+
+    delay(1000);
+}
+
+// NIST SP 800-38A F.1.1 and F.5.1, AES-128
+static const uint8_t SP800_KEY[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static const uint8_t SP800_CTR[16] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+static const uint8_t SP800_PT[64] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+static const uint8_t SP800_ECB[64] = {
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+    0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+    0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+    0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4,
+};
+static const uint8_t SP800_CTR_CT[64] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee,
+};
+
+/**
+ * Both lanes of the 2-block kernel with different known blocks, in both orders, so that a
+ * mixed up or dropped lane shows
+ */
+void aes128_encrypt2_test()
+{
+    const size_t pairs[][2] = {{0, 1}, {3, 2}};
+
+    uint8_t pt[32] = {0};
+    uint8_t enc[32] = {0};
+    uint8_t dec[32] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, SP800_KEY);
+
+    for (size_t n = 0; n < 2; ++n) {
+        memcpy(pt, SP800_PT + 16 * pairs[n][0], 16);
+        memcpy(pt + 16, SP800_PT + 16 * pairs[n][1], 16);
+
+        aes128_encrypt2(enc, pt, rks);
+        aes128_decrypt2(dec, enc, rks);
+
+        for (size_t i = 0; i < 2; ++i) {
+            compare_block("AES-128 2-block Encryption", enc + 16 * i, SP800_ECB + 16 * pairs[n][i]);
+            compare_block("AES-128 2-block Decryption", dec + 16 * i, pt + 16 * i);
+        }
+    }
+}
+
+void aes128_encrypt_test()
+{
+    uint8_t mk[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    uint8_t pt[] = {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34};
+    uint8_t ct[] = {0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32};
+    
+    uint8_t enc[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    aes128_encrypt(enc, pt, rks);
+    compare_block("AES-128 Encryption", enc, ct);
+}
+
+void aes128_decrypt_test() {
+    uint8_t mk[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    uint8_t pt[] = {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34};
+    uint8_t ct[] = {0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32};
+        
+    uint8_t dec[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    aes128_decrypt(dec, ct, rks);
+    compare_block("AES-128 Decryption", dec, pt);
+}
+
+/**
+ * Odd block counts, where the last block goes through the single-block kernel after the pairs,
+ * decrypted in place
+ */
+void aes128_ecb_test()
+{
+    const size_t counts[] = {1, 3};
+
+    uint8_t buffer[48] = {0};
+
+    for (size_t n = 0; n < 2; ++n) {
+        size_t length = 16 * counts[n];
+
+        aes_ecb_encrypt(buffer, SP800_PT, SP800_KEY, length);
+        for (size_t i = 0; i < length; i += 16) {
+            compare_block("AES-128 ECB Encryption", buffer + i, SP800_ECB + i);
+        }
+
+        aes_ecb_decrypt(buffer, buffer, SP800_KEY, length);
+        for (size_t i = 0; i < length; i += 16) {
+            compare_block("AES-128 ECB Decryption", buffer + i, SP800_PT + i);
+        }
+    }
+}
+
+/**
+ * One block, three blocks, and three blocks with half a fourth: a pair, then the odd block
+ * on its own, then a partial keystream block. The SP 800-38A counter carries out of its last
+ * byte between the two blocks of the first pair.
+ */
+void aes128_ctr_test()
+{
+    const size_t lengths[] = {16, 48, 56};
+
+    uint8_t enc[64] = {0};
+    uint8_t dec[64] = {0};
+    uint8_t block[16] = {0};
+    uint8_t expected[16] = {0};
+
+    for (size_t n = 0; n < 3; ++n) {
+        size_t length = lengths[n];
+
+        aes_ctr_encrypt(enc, SP800_PT, SP800_KEY, SP800_CTR, length);
+        aes_ctr_decrypt(dec, enc, SP800_KEY, SP800_CTR, length);
+
+        for (size_t i = 0; i < length; i += 16) {
+            size_t count = (length - i < 16) ? length - i : 16;
+
+            memset(block, 0, sizeof(block));
+            memset(expected, 0, sizeof(expected));
+
+            memcpy(block, enc + i, count);
+            memcpy(expected, SP800_CTR_CT + i, count);
+            compare_block("AES-128 CTR Encryption", block, expected);
+
+            memcpy(block, dec + i, count);
+            memcpy(expected, SP800_PT + i, count);
+            compare_block("AES-128 CTR Decryption", block, expected);
+        }
+    }
+}
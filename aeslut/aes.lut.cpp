@@ -26,69 +26,12 @@
  */
 
 #include <string.h>
-#include "aes.h"
-
-static const uint8_t SBOX[] = {
-    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
-    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
-    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
-    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
-    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
-    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
-    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
-    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
-    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
-    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
-    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
-};
+#include "aes_lut.h"
 
 static const uint32_t RC[] = {
     0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
 };
 
-static const uint8_t GFMUL_2[] = {
-    0x00, 0x02, 0x04, 0x06, 0x08, 0x0a, 0x0c, 0x0e, 0x10, 0x12, 0x14, 0x16, 0x18, 0x1a, 0x1c, 0x1e,
-    0x20, 0x22, 0x24, 0x26, 0x28, 0x2a, 0x2c, 0x2e, 0x30, 0x32, 0x34, 0x36, 0x38, 0x3a, 0x3c, 0x3e,
-    0x40, 0x42, 0x44, 0x46, 0x48, 0x4a, 0x4c, 0x4e, 0x50, 0x52, 0x54, 0x56, 0x58, 0x5a, 0x5c, 0x5e,
-    0x60, 0x62, 0x64, 0x66, 0x68, 0x6a, 0x6c, 0x6e, 0x70, 0x72, 0x74, 0x76, 0x78, 0x7a, 0x7c, 0x7e,
-    0x80, 0x82, 0x84, 0x86, 0x88, 0x8a, 0x8c, 0x8e, 0x90, 0x92, 0x94, 0x96, 0x98, 0x9a, 0x9c, 0x9e,
-    0xa0, 0xa2, 0xa4, 0xa6, 0xa8, 0xaa, 0xac, 0xae, 0xb0, 0xb2, 0xb4, 0xb6, 0xb8, 0xba, 0xbc, 0xbe,
-    0xc0, 0xc2, 0xc4, 0xc6, 0xc8, 0xca, 0xcc, 0xce, 0xd0, 0xd2, 0xd4, 0xd6, 0xd8, 0xda, 0xdc, 0xde,
-    0xe0, 0xe2, 0xe4, 0xe6, 0xe8, 0xea, 0xec, 0xee, 0xf0, 0xf2, 0xf4, 0xf6, 0xf8, 0xfa, 0xfc, 0xfe,
-    0x1b, 0x19, 0x1f, 0x1d, 0x13, 0x11, 0x17, 0x15, 0x0b, 0x09, 0x0f, 0x0d, 0x03, 0x01, 0x07, 0x05,
-    0x3b, 0x39, 0x3f, 0x3d, 0x33, 0x31, 0x37, 0x35, 0x2b, 0x29, 0x2f, 0x2d, 0x23, 0x21, 0x27, 0x25,
-    0x5b, 0x59, 0x5f, 0x5d, 0x53, 0x51, 0x57, 0x55, 0x4b, 0x49, 0x4f, 0x4d, 0x43, 0x41, 0x47, 0x45,
-    0x7b, 0x79, 0x7f, 0x7d, 0x73, 0x71, 0x77, 0x75, 0x6b, 0x69, 0x6f, 0x6d, 0x63, 0x61, 0x67, 0x65,
-    0x9b, 0x99, 0x9f, 0x9d, 0x93, 0x91, 0x97, 0x95, 0x8b, 0x89, 0x8f, 0x8d, 0x83, 0x81, 0x87, 0x85,
-    0xbb, 0xb9, 0xbf, 0xbd, 0xb3, 0xb1, 0xb7, 0xb5, 0xab, 0xa9, 0xaf, 0xad, 0xa3, 0xa1, 0xa7, 0xa5,
-    0xdb, 0xd9, 0xdf, 0xdd, 0xd3, 0xd1, 0xd7, 0xd5, 0xcb, 0xc9, 0xcf, 0xcd, 0xc3, 0xc1, 0xc7, 0xc5,
-    0xfb, 0xf9, 0xff, 0xfd, 0xf3, 0xf1, 0xf7, 0xf5, 0xeb, 0xe9, 0xef, 0xed, 0xe3, 0xe1, 0xe7, 0xe5,
-};
-
-static const uint8_t GFMUL_3[] = {
-    0x00, 0x03, 0x06, 0x05, 0x0c, 0x0f, 0x0a, 0x09, 0x18, 0x1b, 0x1e, 0x1d, 0x14, 0x17, 0x12, 0x11,
-    0x30, 0x33, 0x36, 0x35, 0x3c, 0x3f, 0x3a, 0x39, 0x28, 0x2b, 0x2e, 0x2d, 0x24, 0x27, 0x22, 0x21,
-    0x60, 0x63, 0x66, 0x65, 0x6c, 0x6f, 0x6a, 0x69, 0x78, 0x7b, 0x7e, 0x7d, 0x74, 0x77, 0x72, 0x71,
-    0x50, 0x53, 0x56, 0x55, 0x5c, 0x5f, 0x5a, 0x59, 0x48, 0x4b, 0x4e, 0x4d, 0x44, 0x47, 0x42, 0x41,
-    0xc0, 0xc3, 0xc6, 0xc5, 0xcc, 0xcf, 0xca, 0xc9, 0xd8, 0xdb, 0xde, 0xdd, 0xd4, 0xd7, 0xd2, 0xd1,
-    0xf0, 0xf3, 0xf6, 0xf5, 0xfc, 0xff, 0xfa, 0xf9, 0xe8, 0xeb, 0xee, 0xed, 0xe4, 0xe7, 0xe2, 0xe1,
-    0xa0, 0xa3, 0xa6, 0xa5, 0xac, 0xaf, 0xaa, 0xa9, 0xb8, 0xbb, 0xbe, 0xbd, 0xb4, 0xb7, 0xb2, 0xb1,
-    0x90, 0x93, 0x96, 0x95, 0x9c, 0x9f, 0x9a, 0x99, 0x88, 0x8b, 0x8e, 0x8d, 0x84, 0x87, 0x82, 0x81,
-    0x9b, 0x98, 0x9d, 0x9e, 0x97, 0x94, 0x91, 0x92, 0x83, 0x80, 0x85, 0x86, 0x8f, 0x8c, 0x89, 0x8a,
-    0xab, 0xa8, 0xad, 0xae, 0xa7, 0xa4, 0xa1, 0xa2, 0xb3, 0xb0, 0xb5, 0xb6, 0xbf, 0xbc, 0xb9, 0xba,
-    0xfb, 0xf8, 0xfd, 0xfe, 0xf7, 0xf4, 0xf1, 0xf2, 0xe3, 0xe0, 0xe5, 0xe6, 0xef, 0xec, 0xe9, 0xea,
-    0xcb, 0xc8, 0xcd, 0xce, 0xc7, 0xc4, 0xc1, 0xc2, 0xd3, 0xd0, 0xd5, 0xd6, 0xdf, 0xdc, 0xd9, 0xda,
-    0x5b, 0x58, 0x5d, 0x5e, 0x57, 0x54, 0x51, 0x52, 0x43, 0x40, 0x45, 0x46, 0x4f, 0x4c, 0x49, 0x4a,
-    0x6b, 0x68, 0x6d, 0x6e, 0x67, 0x64, 0x61, 0x62, 0x73, 0x70, 0x75, 0x76, 0x7f, 0x7c, 0x79, 0x7a,
-    0x3b, 0x38, 0x3d, 0x3e, 0x37, 0x34, 0x31, 0x32, 0x23, 0x20, 0x25, 0x26, 0x2f, 0x2c, 0x29, 0x2a,
-    0x0b, 0x08, 0x0d, 0x0e, 0x07, 0x04, 0x01, 0x02, 0x13, 0x10, 0x15, 0x16, 0x1f, 0x1c, 0x19, 0x1a,
-};
-
 static inline uint32_t rot32r8(uint32_t value)
 {
     return (value >> 8) ^ (value << 24);
@@ -96,154 +39,668 @@ static inline uint32_t rot32r8(uint32_t value)
 
 static uint32_t sub_word(uint32_t value)
 {
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        return aes_ni_sub_word(value);
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        return aes_vp_sub_word(value);
+    }
+#endif
+
     uint8_t* ptr = (uint8_t*) &value;
     
-    ptr[0] = SBOX[ptr[0]];
-    ptr[1] = SBOX[ptr[1]];
-    ptr[2] = SBOX[ptr[2]];
-    ptr[3] = SBOX[ptr[3]];
+    ptr[0] = aes_lut_sub_byte(ptr[0]);
+    ptr[1] = aes_lut_sub_byte(ptr[1]);
+    ptr[2] = aes_lut_sub_byte(ptr[2]);
+    ptr[3] = aes_lut_sub_byte(ptr[3]);
 
     return value;
 }
 
-static void add_round_keys(uint8_t* block, const uint8_t* rks) {
-   block[0] ^= rks[0];
-   block[1] ^= rks[4];
-   block[2] ^= rks[8];
-   block[3] ^= rks[12];
+/**
+ * FIPS-197 key expansion for a key of Nk words, Nk + 6 rounds
+ */
+template <size_t Nk>
+static void aes_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    const size_t words = 4 * (Nk + 7);
+    uint32_t* rk = (uint32_t*) rks;
+
+#if defined(AES_LUT_NI)
+    if (Nk == 4 && aes_ni_available()) {
+        aes_ni_keygen128(rks, mk);
+        return;
+    }
+#endif
+
+    memcpy(rk, mk, 4 * Nk);
+
+    for (size_t i = Nk; i < words; ++i) {
+        uint32_t tmp = rk[i - 1];
+
+        if (i % Nk == 0) {
+            tmp = sub_word(rot32r8(tmp)) ^ RC[i / Nk - 1];
+        } else if (Nk > 6 && i % Nk == 4) {
+            tmp = sub_word(tmp);
+        }
+
+        rk[i] = rk[i - Nk] ^ tmp;
+    }
+}
+
+/**
+ * Equivalent inverse cipher key schedule: the encryption round keys in reverse
+ * order, with InvMixColumns applied to every round key except the first and last.
+ */
+template <size_t Nk>
+static void aes_keygen_decrypt(uint8_t* rks, const uint8_t* mk)
+{
+    const size_t rounds = Nk + 6;
+    uint32_t* rk = (uint32_t*) rks;
+
+    aes_keygen<Nk>(rks, mk);
+
+    for (size_t i = 0, j = 4 * rounds; i < j; i += 4, j -= 4) {
+        for (size_t k = 0; k < 4; ++k) {
+            uint32_t tmp = rk[i + k];
+            rk[i + k] = rk[j + k];
+            rk[j + k] = tmp;
+        }
+    }
+
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        aes_ni_inv_mix_columns(rks + 16, rounds - 1);
+        return;
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        aes_vp_inv_mix_columns(rks + 16, rounds - 1);
+        return;
+    }
+#endif
+
+    for (size_t i = 4; i < 4 * rounds; ++i) {
+        rk[i] = aes_lut_inv_mix_column(rk[i]);
+    }
+}
+
+/**
+ * One step of the key expansion on a window of Nk schedule words, word i kept in w[i % Nk].
+ * Word i and word i - Nk share a slot and differ by a function of word i - 1, so the same
+ * step moves the window forward over the schedule or back.
+ */
+template <size_t Nk>
+static void otf_step(uint32_t* w, size_t i)
+{
+    uint32_t tmp = w[(i - 1) % Nk];
+
+    if (i % Nk == 0) {
+        tmp = sub_word(rot32r8(tmp)) ^ RC[i / Nk - 1];
+    } else if (Nk > 6 && i % Nk == 4) {
+        tmp = sub_word(tmp);
+    }
+
+    w[i % Nk] ^= tmp;
+}
+
+/**
+ * Copies the round key of the given round out of the window, first sliding the window
+ * so that it holds words 4 * round to 4 * round + 3. lo is the oldest word in the window.
+ */
+template <size_t Nk>
+static void otf_round_key(uint32_t* rk, uint32_t* w, size_t* lo, size_t round)
+{
+    const size_t first = 4 * round;
+
+    while (*lo + Nk < first + 4) {
+        otf_step<Nk>(w, *lo + Nk);
+        ++*lo;
+    }
+
+    while (*lo > first) {
+        --*lo;
+        otf_step<Nk>(w, *lo + Nk);
+    }
+
+    for (size_t k = 0; k < 4; ++k) {
+        rk[k] = w[(first + k) % Nk];
+    }
+}
+
+template <size_t Nk>
+static void aes_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    size_t lo = 0;
+
+    memcpy(w, mk, 4 * Nk);
+    otf_round_key<Nk>(rk, w, &lo, Nk + 6);
+    memcpy(dk, w, 4 * Nk);
+}
+
+template <size_t Nk>
+static void aes_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    const size_t rounds = Nk + 6;
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    uint32_t block[4];
+    size_t lo = 0;
+
+    memcpy(w, mk, 4 * Nk);
+    memcpy(block, pt, 16);
+
+    otf_round_key<Nk>(rk, w, &lo, 0);
+    for (size_t k = 0; k < 4; ++k) {
+        block[k] ^= rk[k];
+    }
 
-   block[4] ^= rks[1];
-   block[5] ^= rks[5];
-   block[6] ^= rks[9];
-   block[7] ^= rks[13];
+    for (size_t round = 1; round < rounds; ++round) {
+        otf_round_key<Nk>(rk, w, &lo, round);
+        aes_lut_encrypt_round((uint8_t*) block, (const uint8_t*) rk);
+    }
 
-   block[8] ^= rks[2];
-   block[9] ^= rks[6];
-   block[10] ^= rks[10];
-   block[11] ^= rks[14];
+    otf_round_key<Nk>(rk, w, &lo, rounds);
+    aes_lut_encrypt_last_round((uint8_t*) block, (const uint8_t*) rk);
 
-   block[12] ^= rks[3];
-   block[13] ^= rks[7];
-   block[14] ^= rks[11];
-   block[15] ^= rks[15];
+    memcpy(ct, block, 16);
 }
 
-static void swap(uint8_t* block, size_t pos1, size_t pos2)
+/**
+ * The straight round keys come out of the window, the middle ones get InvMixColumns on the
+ * way to match the equivalent inverse cipher rounds of the tier
+ */
+template <size_t Nk>
+static void aes_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
 {
-    uint8_t tmp = block[pos1];
-    block[pos1] = block[pos2];
-    block[pos2] = tmp;
+    const size_t rounds = Nk + 6;
+    uint32_t w[Nk];
+    uint32_t rk[4];
+    uint32_t block[4];
+    size_t lo = 4 * (rounds + 1) - Nk;
+
+    memcpy(w, dk, 4 * Nk);
+    memcpy(block, ct, 16);
+
+    otf_round_key<Nk>(rk, w, &lo, rounds);
+    for (size_t k = 0; k < 4; ++k) {
+        block[k] ^= rk[k];
+    }
+
+    for (size_t round = rounds - 1; round > 0; --round) {
+        otf_round_key<Nk>(rk, w, &lo, round);
+        for (size_t k = 0; k < 4; ++k) {
+            rk[k] = aes_lut_inv_mix_column(rk[k]);
+        }
+        aes_lut_decrypt_round((uint8_t*) block, (const uint8_t*) rk);
+    }
+
+    otf_round_key<Nk>(rk, w, &lo, 0);
+    aes_lut_decrypt_last_round((uint8_t*) block, (const uint8_t*) rk);
+
+    memcpy(pt, block, 16);
 }
 
-static void transpose(uint8_t* block)
+template <size_t Rounds>
+static void aes_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    swap(block, 1, 4);
-    swap(block, 2, 8);
-    swap(block, 3, 12);
-    swap(block, 6, 9);
-    swap(block, 7, 13);
-    swap(block, 11, 14);
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        aes_ni_encrypt<Rounds>(ct, pt, rks);
+        return;
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        aes_vp_encrypt<Rounds>(ct, pt, rks, 1);
+        return;
+    }
+#endif
+
+    aes_lut_encrypt<Rounds>(ct, pt, rks);
 }
 
-static void sub_bytes(uint8_t* block)
+template <size_t Rounds>
+static void aes_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
 {
-    for (int i = 0; i < 16; ++i) {
-        block[i] = SBOX[block[i]];
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        aes_ni_decrypt<Rounds>(pt, ct, rks);
+        return;
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        aes_vp_decrypt<Rounds>(pt, ct, rks, 1);
+        return;
     }
+#endif
+
+    aes_lut_decrypt<Rounds>(pt, ct, rks);
 }
 
-static void shift_rows(uint8_t* block)
+template <size_t Rounds>
+static void aes_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    uint8_t tmp = block[4];
-    block[4] = block[5];
-    block[5] = block[6];
-    block[6] = block[7];
-    block[7] = tmp;
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        aes_ni_encrypt8<Rounds>(ct, pt, rks);
+        return;
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        aes_vp_encrypt<Rounds>(ct, pt, rks, AES_LUT_BULK_BLOCKS);
+        return;
+    }
+#endif
 
-    swap(block, 8, 10);
-    swap(block, 9, 11);
+    for (int i = 0; i < AES_LUT_BULK_BLOCKS; ++i) {
+        aes_lut_encrypt<Rounds>(ct + 16 * i, pt + 16 * i, rks);
+    }
+}
 
-    tmp = block[15];
-    block[15] = block[14];
-    block[14] = block[13];
-    block[13] = block[12];
-    block[12] = tmp;
+template <size_t Rounds>
+static void aes_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        aes_ni_decrypt8<Rounds>(pt, ct, rks);
+        return;
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        aes_vp_decrypt<Rounds>(pt, ct, rks, AES_LUT_BULK_BLOCKS);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < AES_LUT_BULK_BLOCKS; ++i) {
+        aes_lut_decrypt<Rounds>(pt + 16 * i, ct + 16 * i, rks);
+    }
 }
 
-static void inv_shift_rows(uint8_t* block)
+// round 2 terms of column 0 of the round 1 output, its byte in row r moves to column -r
+static void ctr_round2_terms(uint32_t* state, uint32_t col)
 {
-    uint8_t tmp = block[7];
-    block[7] = block[6];
-    block[6] = block[5];
-    block[5] = block[4];
-    block[4] = tmp;
+    const uint8_t* bytes = (const uint8_t*) &col;
 
-    swap(block, 8, 10);
-    swap(block, 9, 11);
+    for (size_t r = 0; r < 4; ++r) {
+        state[(4 - r) & 3] ^= aes_lut_mix_byte(bytes[r], r);
+    }
+}
+
+/**
+ * Rounds 1 and 2 of a counter block that only changes in byte 15. That byte lands in row 3
+ * of column 0 in round 1, so only that column of the round 1 output changes, and round 2
+ * mixes one of its bytes into every column. The cache holds round 1 column 0 and the
+ * round 2 state without the terms of the varying byte, 5 table lookups per block instead of 32.
+ */
+struct ctr_cache {
+    uint8_t k15;
+    uint32_t col;
+    uint32_t state[4];
+};
+
+static void ctr_prepare(ctr_cache& c, const uint8_t* ctr, const uint8_t* rks)
+{
+    const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t state[4];
+
+    memcpy(state, ctr, 16);
+    for (size_t k = 0; k < 4; ++k) {
+        state[k] ^= rk[k];
+    }
+
+    uint8_t x = ((const uint8_t*) state)[15];
+    c.k15 = x ^ ctr[15];
 
-    tmp = block[12];
-    block[12] = block[13];
-    block[13] = block[14];
-    block[14] = block[15];
-    block[15] = tmp;
+    aes_lut_encrypt_round((uint8_t*) state, rks + 16);
+    uint32_t col = state[0];
+    c.col = col ^ aes_lut_mix_byte(x, 3);
+
+    aes_lut_encrypt_round((uint8_t*) state, rks + 32);
+    ctr_round2_terms(state, col);
+    memcpy(c.state, state, 16);
 }
 
-static void mix_columns(uint8_t* in)
+// big endian counter increment, returns the index of the most significant byte that changed
+static size_t increment_counter(uint8_t* ctr)
 {
-    uint8_t block[16] = {0};
+    size_t idx = 15;
+    while (++ctr[idx] == 0 && idx != 0) {
+        --idx;
+    }
+    return idx;
+}
 
-    for (int i = 0; i < 4; ++i) {
-        block[i     ] = GFMUL_2[in[i]] ^ GFMUL_3[in[i + 4]] ^         in[i + 8]  ^         in[i + 12];
-        block[i +  4] =         in[i]  ^ GFMUL_2[in[i + 4]] ^ GFMUL_3[in[i + 8]] ^         in[i + 12];
-        block[i +  8] =         in[i]  ^         in[i + 4]  ^ GFMUL_2[in[i + 8]] ^ GFMUL_3[in[i + 12]];
-        block[i + 12] = GFMUL_3[in[i]] ^         in[i + 4]  ^         in[i + 8]  ^ GFMUL_2[in[i + 12]];
+/**
+ * Whole CTR blocks. AES-NI and the vector permute backend take runs of AES_LUT_BULK_BLOCKS
+ * counters per call and the rest one at a time; the table tiers start every block from the
+ * cached rounds 1 and 2, refreshed when the carry leaves byte 15.
+ */
+template <size_t Rounds>
+static void aes_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+#if defined(AES_LUT_NI) || defined(AES_LUT_VPERM)
+    bool vector = false;
+#if defined(AES_LUT_NI)
+    vector = vector || aes_ni_available();
+#endif
+#if defined(AES_LUT_VPERM)
+    vector = vector || aes_vp_available();
+#endif
+
+    if (vector) {
+        const size_t bulksize = AES_LUT_BULK_BLOCKS * 16;
+        uint8_t counters[bulksize];
+        uint8_t keystreams[bulksize];
+
+        while (blocks > 0) {
+            size_t count = blocks < AES_LUT_BULK_BLOCKS ? blocks : AES_LUT_BULK_BLOCKS;
+            for (size_t i = 0; i < 16 * count; i += 16) {
+                memcpy(counters + i, ctr, 16);
+                increment_counter(ctr);
+            }
+
+            if (count == AES_LUT_BULK_BLOCKS) {
+                aes_encrypt8<Rounds>(keystreams, counters, rks);
+            } else {
+                for (size_t i = 0; i < 16 * count; i += 16) {
+                    aes_encrypt<Rounds>(keystreams + i, counters + i, rks);
+                }
+            }
+
+            for (size_t i = 0; i < 16 * count; ++i) {
+                out[i] = in[i] ^ keystreams[i];
+            }
+
+            in += 16 * count;
+            out += 16 * count;
+            blocks -= count;
+        }
+        return;
     }
+#endif
+
+    uint8_t keystream[16];
+    ctr_cache c;
+    bool stale = true;
+
+    for (; blocks > 0; --blocks) {
+        if (stale) {
+            ctr_prepare(c, ctr, rks);
+        }
+
+        aes_lut_encrypt_ctr<Rounds>(keystream, c.state, c.col, ctr[15] ^ c.k15, rks);
+
+        for (size_t i = 0; i < 16; ++i) {
+            out[i] = in[i] ^ keystream[i];
+        }
 
-    memcpy(in, block, 16);
+        stale = increment_counter(ctr) < 15;
+        in += 16;
+        out += 16;
+    }
 }
 
-static void aes_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t rounds)
+/**
+ * Schedules in AES_RKS_MEM: on AVR one round key at a time is copied out of flash and the
+ * single-round functions run on it, elsewhere the schedule is readable in place
+ */
+template <size_t Rounds>
+static void aes_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    uint8_t block[16] = {0};
-    memcpy(block, pt, 16);
-    transpose(block);
+#if defined(__AVR__)
+    uint32_t rk[4];
+    uint32_t block[4];
 
-    add_round_keys(block, rks);
-    rks += 16;
+    memcpy(block, pt, 16);
+    memcpy_P(rk, rks, 16);
+    for (size_t k = 0; k < 4; ++k) {
+        block[k] ^= rk[k];
+    }
 
-    for (int i = 0; i < rounds - 1; ++i, rks += 16)
-    {
-        sub_bytes(block);
-        shift_rows(block);
-        mix_columns(block);
-        add_round_keys(block, rks);
+    for (size_t round = 1; round < Rounds; ++round) {
+        memcpy_P(rk, rks + 16 * round, 16);
+        aes_lut_encrypt_round((uint8_t*) block, (const uint8_t*) rk);
     }
 
-    sub_bytes(block);
-    shift_rows(block);
-    add_round_keys(block, rks);
+    memcpy_P(rk, rks + 16 * Rounds, 16);
+    aes_lut_encrypt_last_round((uint8_t*) block, (const uint8_t*) rk);
 
-    transpose(block);
     memcpy(ct, block, 16);
+#else
+    aes_encrypt<Rounds>(ct, pt, rks);
+#endif
 }
 
-void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+template <size_t Rounds>
+static void aes_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
 {
-    const uint32_t* key = (const uint32_t*) mk;
-    uint32_t* rk = (uint32_t*) rks;
+#if defined(__AVR__)
+    uint32_t rk[4];
+    uint32_t block[4];
+
+    memcpy(block, ct, 16);
+    memcpy_P(rk, rks, 16);
+    for (size_t k = 0; k < 4; ++k) {
+        block[k] ^= rk[k];
+    }
+
+    for (size_t round = 1; round < Rounds; ++round) {
+        memcpy_P(rk, rks + 16 * round, 16);
+        aes_lut_decrypt_round((uint8_t*) block, (const uint8_t*) rk);
+    }
 
-    memcpy(rk, key, 16);
+    memcpy_P(rk, rks + 16 * Rounds, 16);
+    aes_lut_decrypt_last_round((uint8_t*) block, (const uint8_t*) rk);
 
-    for (int i = 0; i < 10; ++i) {
-        rk[4] = rk[0] ^ sub_word(rot32r8(rk[3])) ^ RC[i];
-        rk[5] = rk[1] ^ rk[4];
-        rk[6] = rk[2] ^ rk[5];
-        rk[7] = rk[3] ^ rk[6];
-        rk += 4;
+    memcpy(pt, block, 16);
+#else
+    aes_decrypt<Rounds>(pt, ct, rks);
+#endif
+}
+
+const char* aes128_backend_name()
+{
+#if defined(AES_LUT_NI)
+    if (aes_ni_available()) {
+        return "AES-NI";
+    }
+#endif
+#if defined(AES_LUT_VPERM)
+    if (aes_vp_available()) {
+        return "SSSE3 vector permute";
     }
+#endif
+
+    return "lookup table";
+}
+
+void aes128_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<4>(rks, mk);
+}
+
+void aes128_keygen_decrypt(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen_decrypt<4>(rks, mk);
 }
 
 void aes128_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
 {
-    aes_encrypt(ct, pt, rks, AES128_ROUNDS);
+    aes_encrypt<AES128_ROUNDS>(ct, pt, rks);
+}
+
+void aes128_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES128_ROUNDS>(pt, ct, rks);
+}
+
+void aes128_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt8<AES128_ROUNDS>(ct, pt, rks);
+}
+
+void aes128_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt8<AES128_ROUNDS>(pt, ct, rks);
+}
+
+void aes128_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES128_ROUNDS>(out, in, ctr, rks, blocks);
+}
+
+void aes128_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt_P<AES128_ROUNDS>(ct, pt, rks);
+}
+
+void aes128_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt_P<AES128_ROUNDS>(pt, ct, rks);
+}
+
+void aes192_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<6>(rks, mk);
+}
+
+void aes192_keygen_decrypt(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen_decrypt<6>(rks, mk);
+}
+
+void aes192_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES192_ROUNDS>(ct, pt, rks);
+}
+
+void aes192_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES192_ROUNDS>(pt, ct, rks);
+}
+
+void aes192_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt8<AES192_ROUNDS>(ct, pt, rks);
+}
+
+void aes192_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt8<AES192_ROUNDS>(pt, ct, rks);
+}
+
+void aes192_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES192_ROUNDS>(out, in, ctr, rks, blocks);
+}
+
+void aes192_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt_P<AES192_ROUNDS>(ct, pt, rks);
+}
+
+void aes192_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt_P<AES192_ROUNDS>(pt, ct, rks);
 }
+
+void aes256_keygen(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen<8>(rks, mk);
+}
+
+void aes256_keygen_decrypt(uint8_t* rks, const uint8_t* mk)
+{
+    aes_keygen_decrypt<8>(rks, mk);
+}
+
+void aes256_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt<AES256_ROUNDS>(ct, pt, rks);
+}
+
+void aes256_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt<AES256_ROUNDS>(pt, ct, rks);
+}
+
+void aes256_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt8<AES256_ROUNDS>(ct, pt, rks);
+}
+
+void aes256_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt8<AES256_ROUNDS>(pt, ct, rks);
+}
+
+void aes256_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    aes_ctr<AES256_ROUNDS>(out, in, ctr, rks, blocks);
+}
+
+void aes256_encrypt_P(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    aes_encrypt_P<AES256_ROUNDS>(ct, pt, rks);
+}
+
+void aes256_decrypt_P(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    aes_decrypt_P<AES256_ROUNDS>(pt, ct, rks);
+}
+
+void aes128_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<4>(dk, mk);
+}
+
+void aes128_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<4>(ct, pt, mk);
+}
+
+void aes128_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<4>(pt, ct, dk);
+}
+
+void aes192_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<6>(dk, mk);
+}
+
+void aes192_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<6>(ct, pt, mk);
+}
+
+void aes192_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<6>(pt, ct, dk);
+}
+
+void aes256_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    aes_keygen_otf_decrypt<8>(dk, mk);
+}
+
+void aes256_encrypt_otf(uint8_t* ct, const uint8_t* pt, const uint8_t* mk)
+{
+    aes_encrypt_otf<8>(ct, pt, mk);
+}
+
+void aes256_decrypt_otf(uint8_t* pt, const uint8_t* ct, const uint8_t* dk)
+{
+    aes_decrypt_otf<8>(pt, ct, dk);
+}
\ No newline at end of file
@@ -0,0 +1,306 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include "aes_lut.h"
+
+#if AES_LUT_TIER == AES_LUT_TIER_SBOX
+
+static const uint8_t SBOX[] LUT_MEM = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static const uint8_t SINV[] LUT_MEM = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d,
+};
+
+const size_t AES_LUT_TABLE_BYTES = sizeof(SBOX) + sizeof(SINV);
+
+static inline uint8_t xtime(uint8_t value)
+{
+    return (value << 1) ^ ((value >> 7) * 0x1b);
+}
+
+static void mix_column(uint8_t* col)
+{
+    uint8_t a0 = col[0];
+    uint8_t a1 = col[1];
+    uint8_t a2 = col[2];
+    uint8_t a3 = col[3];
+    uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+    col[0] = a0 ^ all ^ xtime(a0 ^ a1);
+    col[1] = a1 ^ all ^ xtime(a1 ^ a2);
+    col[2] = a2 ^ all ^ xtime(a2 ^ a3);
+    col[3] = a3 ^ all ^ xtime(a3 ^ a0);
+}
+
+/**
+ * InvMixColumns = MixColumns after multiplying rows 0/2 and 1/3 by {04} crosswise
+ */
+static void inv_mix_column(uint8_t* col)
+{
+    uint8_t u = xtime(xtime(col[0] ^ col[2]));
+    uint8_t v = xtime(xtime(col[1] ^ col[3]));
+
+    col[0] ^= u;
+    col[1] ^= v;
+    col[2] ^= u;
+    col[3] ^= v;
+
+    mix_column(col);
+}
+
+/**
+ * SubBytes and ShiftRows in one pass over the column-major block, row r of column c comes from column c + r
+ */
+static void sub_shift_rows(uint8_t* out, const uint8_t* in)
+{
+    for (int c = 0; c < 16; c += 4) {
+        out[c    ] = lut_read8(SBOX, in[c]);
+        out[c + 1] = lut_read8(SBOX, in[(c +  5) & 15]);
+        out[c + 2] = lut_read8(SBOX, in[(c + 10) & 15]);
+        out[c + 3] = lut_read8(SBOX, in[(c + 15) & 15]);
+    }
+}
+
+static void inv_sub_shift_rows(uint8_t* out, const uint8_t* in)
+{
+    for (int c = 0; c < 16; c += 4) {
+        out[c    ] = lut_read8(SINV, in[c]);
+        out[c + 1] = lut_read8(SINV, in[(c + 13) & 15]);
+        out[c + 2] = lut_read8(SINV, in[(c + 10) & 15]);
+        out[c + 3] = lut_read8(SINV, in[(c +  7) & 15]);
+    }
+}
+
+static void xor_block(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs)
+{
+    for (int i = 0; i < 16; ++i) {
+        out[i] = lhs[i] ^ rhs[i];
+    }
+}
+
+uint8_t aes_lut_sub_byte(uint8_t value)
+{
+    return lut_read8(SBOX, value);
+}
+
+uint32_t aes_lut_inv_mix_column(uint32_t value)
+{
+    uint8_t col[4];
+    memcpy(col, &value, 4);
+    inv_mix_column(col);
+    memcpy(&value, col, 4);
+
+    return value;
+}
+
+// column (2, 1, 1, 3) * S(value) from row 0, moved down to row row
+static AES_LUT_INLINE uint32_t mix_byte(uint8_t value, size_t row)
+{
+    uint8_t sub = lut_read8(SBOX, value);
+    uint8_t col[4];
+    uint32_t out;
+
+    col[row] = xtime(sub);
+    col[(row + 1) & 3] = sub;
+    col[(row + 2) & 3] = sub;
+    col[(row + 3) & 3] = xtime(sub) ^ sub;
+
+    memcpy(&out, col, 4);
+    return out;
+}
+
+uint32_t aes_lut_mix_byte(uint8_t value, size_t row)
+{
+    return mix_byte(value, row);
+}
+
+static AES_LUT_INLINE void encrypt_round(uint8_t* block, const uint8_t* rk)
+{
+    uint8_t tmp[16];
+
+    sub_shift_rows(tmp, block);
+    mix_column(tmp);
+    mix_column(tmp + 4);
+    mix_column(tmp + 8);
+    mix_column(tmp + 12);
+    xor_block(block, tmp, rk);
+}
+
+static AES_LUT_INLINE void encrypt_last_round(uint8_t* out, const uint8_t* block, const uint8_t* rk)
+{
+    uint8_t tmp[16];
+
+    sub_shift_rows(tmp, block);
+    xor_block(out, tmp, rk);
+}
+
+static AES_LUT_INLINE void decrypt_round(uint8_t* block, const uint8_t* rk)
+{
+    uint8_t tmp[16];
+
+    inv_sub_shift_rows(tmp, block);
+    inv_mix_column(tmp);
+    inv_mix_column(tmp + 4);
+    inv_mix_column(tmp + 8);
+    inv_mix_column(tmp + 12);
+    xor_block(block, tmp, rk);
+}
+
+static AES_LUT_INLINE void decrypt_last_round(uint8_t* out, const uint8_t* block, const uint8_t* rk)
+{
+    uint8_t tmp[16];
+
+    inv_sub_shift_rows(tmp, block);
+    xor_block(out, tmp, rk);
+}
+
+void aes_lut_encrypt_round(uint8_t* block, const uint8_t* rk)
+{
+    encrypt_round(block, rk);
+}
+
+void aes_lut_encrypt_last_round(uint8_t* block, const uint8_t* rk)
+{
+    encrypt_last_round(block, block, rk);
+}
+
+void aes_lut_decrypt_round(uint8_t* block, const uint8_t* rk)
+{
+    decrypt_round(block, rk);
+}
+
+void aes_lut_decrypt_last_round(uint8_t* block, const uint8_t* rk)
+{
+    decrypt_last_round(block, block, rk);
+}
+
+template <size_t Rounds>
+void aes_lut_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    uint8_t block[16];
+
+    xor_block(block, pt, rks);
+
+    AES_LUT_UNROLL
+    for (size_t round = 1; round < Rounds; ++round) {
+        rks += 16;
+        encrypt_round(block, rks);
+    }
+
+    rks += 16;
+    encrypt_last_round(ct, block, rks);
+}
+
+// round 2 takes byte r of round 1 column 0 into column -r
+template <size_t Rounds>
+void aes_lut_encrypt_ctr(uint8_t* ct, const uint32_t* state, uint32_t col, uint8_t x, const uint8_t* rks)
+{
+    uint32_t s[4];
+    uint8_t bytes[4];
+
+    col ^= mix_byte(x, 3);
+    memcpy(bytes, &col, 4);
+
+    s[0] = state[0] ^ mix_byte(bytes[0], 0);
+    s[1] = state[1] ^ mix_byte(bytes[3], 3);
+    s[2] = state[2] ^ mix_byte(bytes[2], 2);
+    s[3] = state[3] ^ mix_byte(bytes[1], 1);
+
+    uint8_t* block = (uint8_t*) s;
+    rks += 32;
+
+    AES_LUT_UNROLL
+    for (size_t round = 3; round < Rounds; ++round) {
+        rks += 16;
+        encrypt_round(block, rks);
+    }
+
+    rks += 16;
+    encrypt_last_round(ct, block, rks);
+}
+
+template <size_t Rounds>
+void aes_lut_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    uint8_t block[16];
+
+    xor_block(block, ct, rks);
+
+    AES_LUT_UNROLL
+    for (size_t round = 1; round < Rounds; ++round) {
+        rks += 16;
+        decrypt_round(block, rks);
+    }
+
+    rks += 16;
+    decrypt_last_round(pt, block, rks);
+}
+
+template void aes_lut_encrypt<AES128_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_lut_encrypt<AES192_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_lut_encrypt<AES256_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_lut_decrypt<AES128_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_lut_decrypt<AES192_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_lut_decrypt<AES256_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_lut_encrypt_ctr<AES128_ROUNDS>(uint8_t* ct, const uint32_t* state, uint32_t col, uint8_t x, const uint8_t* rks);
+template void aes_lut_encrypt_ctr<AES192_ROUNDS>(uint8_t* ct, const uint32_t* state, uint32_t col, uint8_t x, const uint8_t* rks);
+template void aes_lut_encrypt_ctr<AES256_ROUNDS>(uint8_t* ct, const uint32_t* state, uint32_t col, uint8_t x, const uint8_t* rks);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,189 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "aes_lut.h"
+
+#if defined(AES_LUT_NI)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+bool aes_ni_available()
+{
+    static int available = -1;
+
+    if (available < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        available = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) && (edx & bit_SSE2);
+    }
+
+    return available != 0;
+}
+
+AES_NI_TARGET static inline __m128i expand_step(__m128i key, __m128i assist)
+{
+    assist = _mm_shuffle_epi32(assist, 0xff);
+
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+
+    return _mm_xor_si128(key, assist);
+}
+
+AES_NI_TARGET void aes_ni_keygen128(uint8_t* rks, const uint8_t* mk)
+{
+    __m128i* rk = (__m128i*) rks;
+    __m128i key = _mm_loadu_si128((const __m128i*) mk);
+
+    // aeskeygenassist takes the round constant as an immediate
+    _mm_storeu_si128(rk + 0, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x01)); _mm_storeu_si128(rk + 1, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x02)); _mm_storeu_si128(rk + 2, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x04)); _mm_storeu_si128(rk + 3, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x08)); _mm_storeu_si128(rk + 4, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x10)); _mm_storeu_si128(rk + 5, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x20)); _mm_storeu_si128(rk + 6, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x40)); _mm_storeu_si128(rk + 7, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x80)); _mm_storeu_si128(rk + 8, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x1b)); _mm_storeu_si128(rk + 9, key);
+    key = expand_step(key, _mm_aeskeygenassist_si128(key, 0x36)); _mm_storeu_si128(rk + 10, key);
+}
+
+// SubWord(X1) is the low word of aeskeygenassist
+AES_NI_TARGET uint32_t aes_ni_sub_word(uint32_t value)
+{
+    __m128i assist = _mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, (int) value, 0), 0);
+    return (uint32_t) _mm_cvtsi128_si32(assist);
+}
+
+AES_NI_TARGET void aes_ni_inv_mix_columns(uint8_t* rks, size_t count)
+{
+    __m128i* rk = (__m128i*) rks;
+
+    for (size_t i = 0; i < count; ++i) {
+        _mm_storeu_si128(rk + i, _mm_aesimc_si128(_mm_loadu_si128(rk + i)));
+    }
+}
+
+template <size_t Rounds>
+AES_NI_TARGET void aes_ni_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    const __m128i* rk = (const __m128i*) rks;
+    __m128i state = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pt), _mm_loadu_si128(rk));
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        state = _mm_aesenc_si128(state, _mm_loadu_si128(rk + r));
+    }
+
+    state = _mm_aesenclast_si128(state, _mm_loadu_si128(rk + Rounds));
+    _mm_storeu_si128((__m128i*) ct, state);
+}
+
+template <size_t Rounds>
+AES_NI_TARGET void aes_ni_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    const __m128i* rk = (const __m128i*) rks;
+    __m128i state = _mm_xor_si128(_mm_loadu_si128((const __m128i*) ct), _mm_loadu_si128(rk));
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        state = _mm_aesdec_si128(state, _mm_loadu_si128(rk + r));
+    }
+
+    state = _mm_aesdeclast_si128(state, _mm_loadu_si128(rk + Rounds));
+    _mm_storeu_si128((__m128i*) pt, state);
+}
+
+/**
+ * Eight independent blocks per round key load hide the aesenc/aesdec latency
+ */
+template <size_t Rounds>
+AES_NI_TARGET void aes_ni_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks)
+{
+    const __m128i* rk = (const __m128i*) rks;
+    __m128i state[8];
+    __m128i key = _mm_loadu_si128(rk);
+
+    for (int i = 0; i < 8; ++i) {
+        state[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) pt + i), key);
+    }
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        key = _mm_loadu_si128(rk + r);
+        for (int i = 0; i < 8; ++i) {
+            state[i] = _mm_aesenc_si128(state[i], key);
+        }
+    }
+
+    key = _mm_loadu_si128(rk + Rounds);
+    for (int i = 0; i < 8; ++i) {
+        _mm_storeu_si128((__m128i*) ct + i, _mm_aesenclast_si128(state[i], key));
+    }
+}
+
+template <size_t Rounds>
+AES_NI_TARGET void aes_ni_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks)
+{
+    const __m128i* rk = (const __m128i*) rks;
+    __m128i state[8];
+    __m128i key = _mm_loadu_si128(rk);
+
+    for (int i = 0; i < 8; ++i) {
+        state[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) ct + i), key);
+    }
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        key = _mm_loadu_si128(rk + r);
+        for (int i = 0; i < 8; ++i) {
+            state[i] = _mm_aesdec_si128(state[i], key);
+        }
+    }
+
+    key = _mm_loadu_si128(rk + Rounds);
+    for (int i = 0; i < 8; ++i) {
+        _mm_storeu_si128((__m128i*) pt + i, _mm_aesdeclast_si128(state[i], key));
+    }
+}
+
+template void aes_ni_encrypt<AES128_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_encrypt<AES192_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_encrypt<AES256_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_decrypt<AES128_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_ni_decrypt<AES192_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_ni_decrypt<AES256_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_ni_encrypt8<AES128_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_encrypt8<AES192_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_encrypt8<AES256_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template void aes_ni_decrypt8<AES128_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_ni_decrypt8<AES192_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template void aes_ni_decrypt8<AES256_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "aes_lut.h"
+
+#if defined(AES_LUT_VPERM)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+/**
+ * Vector permute AES for SSSE3 hosts without AES-NI. Every table below has 16 entries
+ * and is read with pshufb, so no memory access depends on key or data.
+ *
+ * The S-box inverts in GF(16)[Y]/(Y^2 + Y + 8), GF(16) = GF(2)[z]/(z^4 + z + 1).
+ * A byte maps linearly to tower coordinates x = aY + b with one lookup per nibble, and
+ * (aY + b)^-1 = (aY + a + b) / (8a^2 + ab + b^2). Products of two variable nibbles add
+ * logarithms with paddusb, log(0) = 0xf0 keeps bit 7 set through the mod 15 reduction
+ * so that the exp lookup returns zero. The output lookups map back to the AES basis,
+ * folding in the affine transform for encryption.
+ */
+
+// tower coordinates of the input byte, split by nibble; the decryption tables apply the inverse affine first
+static const uint8_t ENC_A_LO[16] = {0x00, 0x00, 0x02, 0x02, 0x04, 0x04, 0x06, 0x06, 0x04, 0x04, 0x06, 0x06, 0x00, 0x00, 0x02, 0x02};
+static const uint8_t ENC_A_HI[16] = {0x00, 0x03, 0x0d, 0x0e, 0x03, 0x00, 0x0e, 0x0d, 0x0e, 0x0d, 0x03, 0x00, 0x0d, 0x0e, 0x00, 0x03};
+static const uint8_t ENC_B_LO[16] = {0x00, 0x01, 0x00, 0x01, 0x06, 0x07, 0x06, 0x07, 0x0c, 0x0d, 0x0c, 0x0d, 0x0a, 0x0b, 0x0a, 0x0b};
+static const uint8_t ENC_B_HI[16] = {0x00, 0x0c, 0x05, 0x09, 0x04, 0x08, 0x01, 0x0d, 0x05, 0x09, 0x00, 0x0c, 0x01, 0x0d, 0x04, 0x08};
+static const uint8_t DEC_A_LO[16] = {0x04, 0x01, 0x0d, 0x08, 0x0d, 0x08, 0x04, 0x01, 0x06, 0x03, 0x0f, 0x0a, 0x0f, 0x0a, 0x06, 0x03};
+static const uint8_t DEC_A_HI[16] = {0x00, 0x07, 0x07, 0x00, 0x0f, 0x08, 0x08, 0x0f, 0x09, 0x0e, 0x0e, 0x09, 0x06, 0x01, 0x01, 0x06};
+static const uint8_t DEC_B_LO[16] = {0x07, 0x0f, 0x08, 0x00, 0x0f, 0x07, 0x00, 0x08, 0x0f, 0x07, 0x00, 0x08, 0x07, 0x0f, 0x08, 0x00};
+static const uint8_t DEC_B_HI[16] = {0x00, 0x06, 0x09, 0x0f, 0x09, 0x0f, 0x00, 0x06, 0x02, 0x04, 0x0b, 0x0d, 0x0b, 0x0d, 0x02, 0x04};
+
+// back to the AES basis from (high, low) tower nibbles; the encryption tables include the affine transform
+static const uint8_t ENC_OUT_LO[16] = {0x63, 0x7c, 0xd1, 0xce, 0xc8, 0xd7, 0x7a, 0x65, 0x55, 0x4a, 0xe7, 0xf8, 0xfe, 0xe1, 0x4c, 0x53};
+static const uint8_t ENC_OUT_HI[16] = {0x00, 0x52, 0x3e, 0x6c, 0x65, 0x37, 0x5b, 0x09, 0x60, 0x32, 0x5e, 0x0c, 0x05, 0x57, 0x3b, 0x69};
+static const uint8_t DEC_OUT_LO[16] = {0x00, 0x01, 0x5c, 0x5d, 0xe0, 0xe1, 0xbc, 0xbd, 0x50, 0x51, 0x0c, 0x0d, 0xb0, 0xb1, 0xec, 0xed};
+static const uint8_t DEC_OUT_HI[16] = {0x00, 0xa2, 0x02, 0xa0, 0xb8, 0x1a, 0xba, 0x18, 0xdb, 0x79, 0xd9, 0x7b, 0x63, 0xc1, 0x61, 0xc3};
+
+// GF(16) arithmetic, log(0) = log(1/0) = 0xf0
+static const uint8_t GF16_LOG[16] = {0xf0, 0x00, 0x01, 0x04, 0x02, 0x08, 0x05, 0x0a, 0x03, 0x0e, 0x09, 0x07, 0x06, 0x0d, 0x0b, 0x0c};
+static const uint8_t GF16_EXP[16] = {0x01, 0x02, 0x04, 0x08, 0x03, 0x06, 0x0c, 0x0b, 0x05, 0x0a, 0x07, 0x0e, 0x0f, 0x0d, 0x09, 0x00};
+static const uint8_t GF16_LOG_INV[16] = {0xf0, 0x00, 0x0e, 0x0b, 0x0d, 0x07, 0x0a, 0x05, 0x0c, 0x01, 0x06, 0x08, 0x09, 0x02, 0x04, 0x03};
+static const uint8_t GF16_SQUARE_LAMBDA[16] = {0x00, 0x08, 0x06, 0x0e, 0x0b, 0x03, 0x0d, 0x05, 0x0a, 0x02, 0x0c, 0x04, 0x01, 0x09, 0x07, 0x0f};
+static const uint8_t GF16_SQUARE[16] = {0x00, 0x01, 0x04, 0x05, 0x03, 0x02, 0x07, 0x06, 0x0c, 0x0d, 0x08, 0x09, 0x0f, 0x0e, 0x0b, 0x0a};
+
+static const uint8_t SHIFT_ROWS[16] = {0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11};
+static const uint8_t INV_SHIFT_ROWS[16] = {0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3};
+static const uint8_t ROT_ROWS1[16] = {1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12};
+static const uint8_t ROT_ROWS2[16] = {2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13};
+
+struct vp_sbox {
+    __m128i a_lo, a_hi, b_lo, b_hi, out_lo, out_hi;
+};
+
+struct vp_tables {
+    __m128i log, exp, log_inv, square_lambda, square;
+    __m128i shift_rows, rot1, rot2;
+    vp_sbox sbox;
+};
+
+bool aes_vp_available()
+{
+    static int available = -1;
+
+    if (available < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        available = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3);
+    }
+
+    return available != 0;
+}
+
+AES_VP_TARGET static inline __m128i load(const uint8_t* table)
+{
+    return _mm_loadu_si128((const __m128i*) table);
+}
+
+AES_VP_TARGET static inline __m128i lookup(__m128i table, __m128i index)
+{
+    return _mm_shuffle_epi8(table, index);
+}
+
+AES_VP_TARGET static void load_tables(vp_tables* t, bool inverse)
+{
+    t->log = load(GF16_LOG);
+    t->exp = load(GF16_EXP);
+    t->log_inv = load(GF16_LOG_INV);
+    t->square_lambda = load(GF16_SQUARE_LAMBDA);
+    t->square = load(GF16_SQUARE);
+    t->rot1 = load(ROT_ROWS1);
+    t->rot2 = load(ROT_ROWS2);
+
+    if (inverse) {
+        t->shift_rows = load(INV_SHIFT_ROWS);
+        t->sbox.a_lo = load(DEC_A_LO);
+        t->sbox.a_hi = load(DEC_A_HI);
+        t->sbox.b_lo = load(DEC_B_LO);
+        t->sbox.b_hi = load(DEC_B_HI);
+        t->sbox.out_lo = load(DEC_OUT_LO);
+        t->sbox.out_hi = load(DEC_OUT_HI);
+    } else {
+        t->shift_rows = load(SHIFT_ROWS);
+        t->sbox.a_lo = load(ENC_A_LO);
+        t->sbox.a_hi = load(ENC_A_HI);
+        t->sbox.b_lo = load(ENC_B_LO);
+        t->sbox.b_hi = load(ENC_B_HI);
+        t->sbox.out_lo = load(ENC_OUT_LO);
+        t->sbox.out_hi = load(ENC_OUT_HI);
+    }
+}
+
+/**
+ * Sums of two logarithms are 0..28 or at least 0xf0, reduce the former mod 15
+ */
+AES_VP_TARGET static inline __m128i log_add(__m128i lhs, __m128i rhs)
+{
+    __m128i sum = _mm_adds_epu8(lhs, rhs);
+    return _mm_min_epu8(sum, _mm_sub_epi8(sum, _mm_set1_epi8(15)));
+}
+
+AES_VP_TARGET static inline __m128i sub_bytes(__m128i x, const vp_tables& t)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i lo = _mm_and_si128(x, nibble);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+
+    __m128i a = _mm_xor_si128(lookup(t.sbox.a_lo, lo), lookup(t.sbox.a_hi, hi));
+    __m128i b = _mm_xor_si128(lookup(t.sbox.b_lo, lo), lookup(t.sbox.b_hi, hi));
+
+    __m128i log_a = lookup(t.log, a);
+    __m128i ab = lookup(t.exp, log_add(log_a, lookup(t.log, b)));
+
+    __m128i d = _mm_xor_si128(_mm_xor_si128(lookup(t.square_lambda, a), lookup(t.square, b)), ab);
+    __m128i log_dinv = lookup(t.log_inv, d);
+
+    __m128i out_a = lookup(t.exp, log_add(log_a, log_dinv));
+    __m128i out_b = lookup(t.exp, log_add(lookup(t.log, _mm_xor_si128(a, b)), log_dinv));
+
+    return _mm_xor_si128(lookup(t.sbox.out_lo, out_b), lookup(t.sbox.out_hi, out_a));
+}
+
+AES_VP_TARGET static inline __m128i xtime(__m128i x)
+{
+    __m128i carry = _mm_cmplt_epi8(x, _mm_setzero_si128());
+    return _mm_xor_si128(_mm_add_epi8(x, x), _mm_and_si128(carry, _mm_set1_epi8(0x1b)));
+}
+
+/**
+ * 2a0 + 3a1 + a2 + a3 = 2(a0 + a1) + a1 + (a2 + a3), with rows rotated inside each column by pshufb
+ */
+AES_VP_TARGET static inline __m128i mix_columns(__m128i x, const vp_tables& t)
+{
+    __m128i r1 = lookup(x, t.rot1);
+    __m128i a = _mm_xor_si128(x, r1);
+
+    return _mm_xor_si128(_mm_xor_si128(xtime(a), r1), lookup(a, t.rot2));
+}
+
+AES_VP_TARGET static inline __m128i inv_mix_columns(__m128i x, const vp_tables& t)
+{
+    __m128i u = xtime(xtime(_mm_xor_si128(x, lookup(x, t.rot2))));
+    return mix_columns(_mm_xor_si128(x, u), t);
+}
+
+template <size_t Rounds>
+AES_VP_TARGET static inline __m128i encrypt_block(__m128i state, const __m128i* rk, const vp_tables& t)
+{
+    state = _mm_xor_si128(state, _mm_loadu_si128(rk));
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        state = sub_bytes(lookup(state, t.shift_rows), t);
+        state = _mm_xor_si128(mix_columns(state, t), _mm_loadu_si128(rk + r));
+    }
+
+    state = sub_bytes(lookup(state, t.shift_rows), t);
+    return _mm_xor_si128(state, _mm_loadu_si128(rk + Rounds));
+}
+
+template <size_t Rounds>
+AES_VP_TARGET static inline __m128i decrypt_block(__m128i state, const __m128i* rk, const vp_tables& t)
+{
+    state = _mm_xor_si128(state, _mm_loadu_si128(rk));
+
+    AES_LUT_UNROLL
+    for (size_t r = 1; r < Rounds; ++r) {
+        state = sub_bytes(lookup(state, t.shift_rows), t);
+        state = _mm_xor_si128(inv_mix_columns(state, t), _mm_loadu_si128(rk + r));
+    }
+
+    state = sub_bytes(lookup(state, t.shift_rows), t);
+    return _mm_xor_si128(state, _mm_loadu_si128(rk + Rounds));
+}
+
+AES_VP_TARGET uint32_t aes_vp_sub_word(uint32_t value)
+{
+    vp_tables t;
+    load_tables(&t, false);
+
+    return (uint32_t) _mm_cvtsi128_si32(sub_bytes(_mm_cvtsi32_si128((int) value), t));
+}
+
+AES_VP_TARGET void aes_vp_inv_mix_columns(uint8_t* rks, size_t count)
+{
+    __m128i* rk = (__m128i*) rks;
+
+    vp_tables t;
+    load_tables(&t, true);
+
+    for (size_t i = 0; i < count; ++i) {
+        _mm_storeu_si128(rk + i, inv_mix_columns(_mm_loadu_si128(rk + i), t));
+    }
+}
+
+template <size_t Rounds>
+AES_VP_TARGET void aes_vp_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t blocks)
+{
+    vp_tables t;
+    load_tables(&t, false);
+
+    for (size_t i = 0; i < blocks; ++i) {
+        __m128i state = _mm_loadu_si128((const __m128i*) pt + i);
+        state = encrypt_block<Rounds>(state, (const __m128i*) rks, t);
+        _mm_storeu_si128((__m128i*) ct + i, state);
+    }
+}
+
+template <size_t Rounds>
+AES_VP_TARGET void aes_vp_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t blocks)
+{
+    vp_tables t;
+    load_tables(&t, true);
+
+    for (size_t i = 0; i < blocks; ++i) {
+        __m128i state = _mm_loadu_si128((const __m128i*) ct + i);
+        state = decrypt_block<Rounds>(state, (const __m128i*) rks, t);
+        _mm_storeu_si128((__m128i*) pt + i, state);
+    }
+}
+
+template void aes_vp_encrypt<AES128_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t blocks);
+template void aes_vp_encrypt<AES192_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t blocks);
+template void aes_vp_encrypt<AES256_ROUNDS>(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t blocks);
+template void aes_vp_decrypt<AES128_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t blocks);
+template void aes_vp_decrypt<AES192_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t blocks);
+template void aes_vp_decrypt<AES256_ROUNDS>(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t blocks);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "aes_blob.h"
+#include "HardwareSerial.h"
+#include <string.h>
+
+static uint8_t blob_algorithm(size_t keysize)
+{
+    switch (keysize) {
+    case 16:
+        return AES_BLOB_AES128;
+    case 24:
+        return AES_BLOB_AES192;
+    case 32:
+        return AES_BLOB_AES256;
+    }
+
+    Serial.println("key size is not 16, 24 or 32");
+    return 0;
+}
+
+// schedule length follows from the key size: 16 bytes for each of keysize / 4 + 7 round keys
+static size_t blob_rks_size(size_t keysize)
+{
+    return 16 * (keysize / 4 + 7);
+}
+
+/**
+ * Fletcher-16, reducing modulo 255 once per 256 bytes instead of per byte: the 32-bit sums
+ * cannot overflow within a chunk
+ */
+static void fletcher16(uint32_t* sum1, uint32_t* sum2, const uint8_t* data, size_t length)
+{
+    uint32_t s1 = *sum1;
+    uint32_t s2 = *sum2;
+
+    while (length > 0) {
+        size_t chunk = length < 256 ? length : 256;
+
+        for (size_t i = 0; i < chunk; ++i) {
+            s1 += data[i];
+            s2 += s1;
+        }
+        s1 %= 255;
+        s2 %= 255;
+
+        data += chunk;
+        length -= chunk;
+    }
+
+    *sum1 = s1;
+    *sum2 = s2;
+}
+
+static uint16_t blob_checksum(const uint8_t* blob, size_t rks_size)
+{
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    fletcher16(&sum1, &sum2, blob, 6);
+    fletcher16(&sum1, &sum2, blob + AES_BLOB_HEADER_SIZE, rks_size);
+
+    return (sum2 << 8) | sum1;
+}
+
+size_t aes_blob_store(uint8_t* blob, const uint8_t* rks, size_t keysize, uint8_t type)
+{
+    uint8_t algorithm = blob_algorithm(keysize);
+    if (algorithm == 0) {
+        return 0;
+    }
+
+    size_t rks_size = blob_rks_size(keysize);
+
+    blob[0] = 'K';
+    blob[1] = 'S';
+    blob[2] = AES_BLOB_VERSION;
+    blob[3] = algorithm;
+    blob[4] = type;
+    blob[5] = 0;
+    memcpy(blob + AES_BLOB_HEADER_SIZE, rks, rks_size);
+
+    uint16_t checksum = blob_checksum(blob, rks_size);
+    blob[6] = (uint8_t) checksum;
+    blob[7] = (uint8_t) (checksum >> 8);
+
+    return AES_BLOB_SIZE(rks_size);
+}
+
+const uint8_t* aes_blob_load(const uint8_t* blob, size_t length, size_t keysize, uint8_t type)
+{
+    uint8_t algorithm = blob_algorithm(keysize);
+    if (algorithm == 0) {
+        return NULL;
+    }
+
+    size_t rks_size = blob_rks_size(keysize);
+
+    if (length < AES_BLOB_SIZE(rks_size) || blob[0] != 'K' || blob[1] != 'S') {
+        Serial.println("not a key schedule blob");
+        return NULL;
+    }
+
+    if (blob[2] != AES_BLOB_VERSION) {
+        Serial.println("key schedule blob version is not supported");
+        return NULL;
+    }
+
+    if (blob[3] != algorithm || blob[4] != type) {
+        Serial.println("key schedule blob is for another cipher");
+        return NULL;
+    }
+
+    uint16_t checksum = blob_checksum(blob, rks_size);
+    if (blob[6] != (uint8_t) checksum || blob[7] != (uint8_t) (checksum >> 8)) {
+        Serial.println("key schedule blob checksum mismatch");
+        return NULL;
+    }
+
+    return blob + AES_BLOB_HEADER_SIZE;
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes.h"
+
+/**
+ * Tables live in flash on AVR, where 8-bit boards have only a few KB of RAM
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define LUT_MEM PROGMEM
+#define lut_read8(table, index) pgm_read_byte(&(table)[index])
+#define lut_read32(table, index) pgm_read_dword(&(table)[index])
+#else
+#define LUT_MEM
+#define lut_read8(table, index) ((table)[index])
+#define lut_read32(table, index) ((table)[index])
+#endif
+
+/**
+ * Every block kernel is a template on its round count, instantiated for AES128_ROUNDS,
+ * AES192_ROUNDS and AES256_ROUNDS. With the count known at compile time the round loops
+ * are unrolled completely; compilers without the pragma still get a constant trip count.
+ */
+#if defined(__clang__)
+#define AES_LUT_UNROLL _Pragma("clang loop unroll(full)")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define AES_LUT_UNROLL _Pragma("GCC unroll 16")
+#else
+#define AES_LUT_UNROLL
+#endif
+
+// round bodies shared by the kernels and the single-round functions must still inline into the kernels
+#if defined(__GNUC__)
+#define AES_LUT_INLINE inline __attribute__((always_inline))
+#else
+#define AES_LUT_INLINE inline
+#endif
+
+/**
+ * Round kernels provided by the table tier selected with AES_LUT_TIER
+ */
+uint8_t aes_lut_sub_byte(uint8_t value);
+uint32_t aes_lut_inv_mix_column(uint32_t value);
+template <size_t Rounds> void aes_lut_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template <size_t Rounds> void aes_lut_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+
+/**
+ * For the CTR cache: mix_byte is the MixColumns column of S(value) sitting in row row, TE_row[value].
+ * encrypt_ctr finishes a counter block from the cache: round 1 column 0 is col plus the row 3
+ * term of x, its round 2 terms are added to state, and rounds 3 to Rounds follow.
+ */
+uint32_t aes_lut_mix_byte(uint8_t value, size_t row);
+template <size_t Rounds> void aes_lut_encrypt_ctr(uint8_t* ct, const uint32_t* state, uint32_t col, uint8_t x, const uint8_t* rks);
+
+// single rounds on a column-major block for the on-the-fly schedule, decryption takes equivalent inverse cipher round keys
+void aes_lut_encrypt_round(uint8_t* block, const uint8_t* rk);
+void aes_lut_encrypt_last_round(uint8_t* block, const uint8_t* rk);
+void aes_lut_decrypt_round(uint8_t* block, const uint8_t* rk);
+void aes_lut_decrypt_last_round(uint8_t* block, const uint8_t* rk);
+
+/**
+ * AES-NI backend for x86 hosts, picked at runtime when CPUID reports the instructions.
+ * Define AES_LUT_NO_NI to build the table code only.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(AES_LUT_NO_NI)
+#define AES_LUT_NI 1
+#define AES_NI_TARGET __attribute__((target("aes,sse2")))
+
+bool aes_ni_available();
+uint32_t aes_ni_sub_word(uint32_t value);
+void aes_ni_keygen128(uint8_t* rks, const uint8_t* mk);
+void aes_ni_inv_mix_columns(uint8_t* rks, size_t count);
+template <size_t Rounds> AES_NI_TARGET void aes_ni_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template <size_t Rounds> AES_NI_TARGET void aes_ni_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+template <size_t Rounds> AES_NI_TARGET void aes_ni_encrypt8(uint8_t* ct, const uint8_t* pt, const uint8_t* rks);
+template <size_t Rounds> AES_NI_TARGET void aes_ni_decrypt8(uint8_t* pt, const uint8_t* ct, const uint8_t* rks);
+#endif
+
+/**
+ * Constant-time SSSE3 vector permute backend, picked when AES-NI is missing.
+ * Define AES_LUT_NO_VPERM to leave it out.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(AES_LUT_NO_VPERM)
+#define AES_LUT_VPERM 1
+#define AES_VP_TARGET __attribute__((target("ssse3")))
+
+bool aes_vp_available();
+uint32_t aes_vp_sub_word(uint32_t value);
+void aes_vp_inv_mix_columns(uint8_t* rks, size_t count);
+template <size_t Rounds> AES_VP_TARGET void aes_vp_encrypt(uint8_t* ct, const uint8_t* pt, const uint8_t* rks, size_t blocks);
+template <size_t Rounds> AES_VP_TARGET void aes_vp_decrypt(uint8_t* pt, const uint8_t* ct, const uint8_t* rks, size_t blocks);
+#endif
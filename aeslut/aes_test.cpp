@@ -29,6 +29,8 @@
 #include "aes_test.h"
 #include "aes.h"
 #include "aes_mode.h"
+#include "aes_const.h"
+#include "aes_blob.h"
 #include "Arduino.h"
 
 static const size_t RKS_SIZE = (AES128_ROUNDS + 1) * 16;
@@ -95,6 +97,129 @@ void aes128_benchmark()
     delay(1000);
 }
 
+static void print_cycles_per_byte(const char* title, long elapsed, size_t length)
+{
+    Serial.print(title);
+#if defined(F_CPU)
+    Serial.println((float) elapsed * (F_CPU / 1000000L) / length);
+#else
+    Serial.print((float) elapsed / length);
+    Serial.println(" us");
+#endif
+}
+
+void aes128_tier_benchmark()
+{
+    const size_t blocks = 256;
+
+    uint8_t mk[16] = {0};
+    uint8_t block[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    long start = micros();
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_encrypt(block, block, rks);
+    }
+    long elapsed_enc = micros() - start;
+
+    aes128_keygen_decrypt(rks, mk);
+
+    start = micros();
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_decrypt(block, block, rks);
+    }
+    long elapsed_dec = micros() - start;
+
+#if AES_LUT_TIER == AES_LUT_TIER_SBOX
+    Serial.println("AES-128 table tier: S-box with xtime MixColumns");
+#elif AES_LUT_TIER == AES_LUT_TIER_T1
+    Serial.println("AES-128 table tier: one rotated T-table");
+#else
+    Serial.println("AES-128 table tier: four T-tables");
+#endif
+    Serial.print("AES-128 backend: ");
+    Serial.println(aes128_backend_name());
+
+#if defined(__AVR__)
+    Serial.print("Table bytes in flash: ");
+#else
+    Serial.print("Table bytes in RAM: ");
+#endif
+    Serial.println(AES_LUT_TABLE_BYTES);
+    Serial.print("Round key bytes in RAM: ");
+    Serial.println(RKS_SIZE);
+
+    print_cycles_per_byte("Encryption cycles per byte: ", elapsed_enc, blocks * 16);
+    print_cycles_per_byte("Decryption cycles per byte: ", elapsed_dec, blocks * 16);
+
+    for (size_t i = 0; i < 16; ++i) {
+        if (block[i] != 0) {
+            Serial.println("tier round trip failed");
+            break;
+        }
+    }
+
+    delay(1000);
+}
+
+void aes128_bulk_benchmark()
+{
+    const size_t length = 4096;
+    static uint8_t buffer[length];
+
+    uint8_t mk[16] = {0};
+    uint8_t ctr[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    long start = micros();
+    for (size_t i = 0; i < length; i += 16) {
+        aes128_encrypt(buffer + i, buffer + i, rks);
+    }
+    long elapsed_single = micros() - start;
+
+    start = micros();
+    aes_ctr_encrypt(buffer, buffer, mk, sizeof(mk), ctr, length);
+    long elapsed_ctr = micros() - start;
+
+    print_cycles_per_byte("Single block encryption cycles per byte: ", elapsed_single, length);
+    print_cycles_per_byte("CTR mode cycles per byte: ", elapsed_ctr, length);
+
+    delay(1000);
+}
+
+void aes128_encrypt8_test()
+{
+    uint8_t mk[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    uint8_t pt[16 * AES_LUT_BULK_BLOCKS] = {0};
+    uint8_t enc[16 * AES_LUT_BULK_BLOCKS] = {0};
+    uint8_t dec[16 * AES_LUT_BULK_BLOCKS] = {0};
+    uint8_t single[16] = {0};
+
+    for (size_t i = 0; i < sizeof(pt); ++i) {
+        pt[i] = i * 7 + 1;
+    }
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+    aes128_encrypt8(enc, pt, rks);
+
+    for (size_t i = 0; i < AES_LUT_BULK_BLOCKS; ++i) {
+        aes128_encrypt(single, pt + 16 * i, rks);
+        compare_block("AES-128 8-block Encryption", enc + 16 * i, single);
+    }
+
+    aes128_keygen_decrypt(rks, mk);
+    aes128_decrypt8(dec, enc, rks);
+
+    for (size_t i = 0; i < AES_LUT_BULK_BLOCKS; ++i) {
+        compare_block("AES-128 8-block Decryption", dec + 16 * i, pt + 16 * i);
+    }
+}
+
 void aes128_encrypt_test()
 {
     uint8_t mk[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
@@ -118,12 +243,253 @@ void aes128_decrypt_test() {
     uint8_t dec[16] = {0};
 
     uint8_t rks[RKS_SIZE] = {0,};
-    aes128_keygen(rks, mk);
+    aes128_keygen_decrypt(rks, mk);
 
     aes128_decrypt(dec, ct, rks);
     compare_block("AES-128 Decryption", dec, pt);
 }
 
+void aes192_test()
+{
+    uint8_t mk[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17};
+    uint8_t pt[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    uint8_t ct[] = {0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+
+    uint8_t rks[AES192_RKS_SIZE] = {0,};
+    aes192_keygen(rks, mk);
+
+    aes192_encrypt(enc, pt, rks);
+    compare_block("AES-192 Encryption", enc, ct);
+
+    aes192_keygen_decrypt(rks, mk);
+
+    aes192_decrypt(dec, ct, rks);
+    compare_block("AES-192 Decryption", dec, pt);
+}
+
+void aes256_test()
+{
+    uint8_t mk[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    uint8_t pt[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    uint8_t ct[] = {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+
+    uint8_t rks[AES256_RKS_SIZE] = {0,};
+    aes256_keygen(rks, mk);
+
+    aes256_encrypt(enc, pt, rks);
+    compare_block("AES-256 Encryption", enc, ct);
+
+    aes256_keygen_decrypt(rks, mk);
+
+    aes256_decrypt(dec, ct, rks);
+    compare_block("AES-256 Decryption", dec, pt);
+}
+
+/**
+ * The on-the-fly functions against the stored schedule, for every key size
+ */
+void aes_otf_test()
+{
+    uint8_t mk[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    uint8_t pt[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+    uint8_t otf[16] = {0};
+
+    uint8_t rks[AES_MAX_RKS_SIZE] = {0,};
+    uint8_t dk[AES_MAX_KEY_SIZE] = {0,};
+
+    aes128_keygen(rks, mk);
+    aes128_encrypt(enc, pt, rks);
+    aes128_encrypt_otf(otf, pt, mk);
+    compare_block("AES-128 On-the-fly Encryption", otf, enc);
+
+    aes128_keygen_otf_decrypt(dk, mk);
+    compare_block("AES-128 On-the-fly Final Round Key", dk, rks + AES128_ROUNDS * 16);
+    aes128_decrypt_otf(dec, enc, dk);
+    compare_block("AES-128 On-the-fly Decryption", dec, pt);
+
+    aes192_keygen(rks, mk);
+    aes192_encrypt(enc, pt, rks);
+    aes192_encrypt_otf(otf, pt, mk);
+    compare_block("AES-192 On-the-fly Encryption", otf, enc);
+
+    aes192_keygen_otf_decrypt(dk, mk);
+    aes192_decrypt_otf(dec, enc, dk);
+    compare_block("AES-192 On-the-fly Decryption", dec, pt);
+
+    aes256_keygen(rks, mk);
+    aes256_encrypt(enc, pt, rks);
+    aes256_encrypt_otf(otf, pt, mk);
+    compare_block("AES-256 On-the-fly Encryption", otf, enc);
+
+    aes256_keygen_otf_decrypt(dk, mk);
+    aes256_decrypt_otf(dec, enc, dk);
+    compare_block("AES-256 On-the-fly Decryption", dec, pt);
+}
+
+static constexpr uint8_t CONST_KEY[32] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+
+static const uint8_t CONST_RKS128[AES128_RKS_SIZE] AES_RKS_MEM = { AES128_KEYGEN_CONST(CONST_KEY) };
+static const uint8_t CONST_DRKS128[AES128_RKS_SIZE] AES_RKS_MEM = { AES128_KEYGEN_DECRYPT_CONST(CONST_KEY) };
+static const uint8_t CONST_RKS192[AES192_RKS_SIZE] AES_RKS_MEM = { AES192_KEYGEN_CONST(CONST_KEY) };
+static const uint8_t CONST_DRKS192[AES192_RKS_SIZE] AES_RKS_MEM = { AES192_KEYGEN_DECRYPT_CONST(CONST_KEY) };
+static const uint8_t CONST_RKS256[AES256_RKS_SIZE] AES_RKS_MEM = { AES256_KEYGEN_CONST(CONST_KEY) };
+static const uint8_t CONST_DRKS256[AES256_RKS_SIZE] AES_RKS_MEM = { AES256_KEYGEN_DECRYPT_CONST(CONST_KEY) };
+
+static void compare_const_schedule(const char* title, const uint8_t* rks_P, const uint8_t* rks, size_t size)
+{
+    uint8_t copy[AES_MAX_RKS_SIZE] = {0,};
+#if defined(__AVR__)
+    memcpy_P(copy, rks_P, size);
+#else
+    memcpy(copy, rks_P, size);
+#endif
+
+    for (size_t i = 0; i < size; i += 16) {
+        if (memcmp(copy + i, rks + i, 16) != 0) {
+            compare_block(title, copy + i, rks + i);
+            return;
+        }
+    }
+    compare_block(title, copy, rks);
+}
+
+/**
+ * Schedules baked at compile time against keygen, and the _P functions on them against the
+ * key-based ones. The mode messages are long enough to reach the 8-block path.
+ */
+void aes_const_keygen_test()
+{
+    uint8_t pt[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    uint8_t ctr[] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+    uint8_t msg[152] = {0};
+    uint8_t out[152] = {0};
+    uint8_t out_P[152] = {0};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+    uint8_t rks[AES_MAX_RKS_SIZE] = {0,};
+
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = i;
+    }
+
+    aes128_keygen(rks, CONST_KEY);
+    compare_const_schedule("AES-128 Compile-time Key Schedule", CONST_RKS128, rks, AES128_RKS_SIZE);
+    aes128_keygen_decrypt(rks, CONST_KEY);
+    compare_const_schedule("AES-128 Compile-time Decryption Key Schedule", CONST_DRKS128, rks, AES128_RKS_SIZE);
+
+    aes128_keygen(rks, CONST_KEY);
+    aes128_encrypt(enc, pt, rks);
+    aes128_encrypt_P(out, pt, CONST_RKS128);
+    compare_block("AES-128 Flash Schedule Encryption", out, enc);
+    aes128_decrypt_P(dec, enc, CONST_DRKS128);
+    compare_block("AES-128 Flash Schedule Decryption", dec, pt);
+
+    aes192_keygen(rks, CONST_KEY);
+    compare_const_schedule("AES-192 Compile-time Key Schedule", CONST_RKS192, rks, AES192_RKS_SIZE);
+    aes192_keygen_decrypt(rks, CONST_KEY);
+    compare_const_schedule("AES-192 Compile-time Decryption Key Schedule", CONST_DRKS192, rks, AES192_RKS_SIZE);
+
+    aes192_keygen(rks, CONST_KEY);
+    aes192_encrypt(enc, pt, rks);
+    aes192_encrypt_P(out, pt, CONST_RKS192);
+    compare_block("AES-192 Flash Schedule Encryption", out, enc);
+    aes192_decrypt_P(dec, enc, CONST_DRKS192);
+    compare_block("AES-192 Flash Schedule Decryption", dec, pt);
+
+    aes256_keygen(rks, CONST_KEY);
+    compare_const_schedule("AES-256 Compile-time Key Schedule", CONST_RKS256, rks, AES256_RKS_SIZE);
+    aes256_keygen_decrypt(rks, CONST_KEY);
+    compare_const_schedule("AES-256 Compile-time Decryption Key Schedule", CONST_DRKS256, rks, AES256_RKS_SIZE);
+
+    aes256_keygen(rks, CONST_KEY);
+    aes256_encrypt(enc, pt, rks);
+    aes256_encrypt_P(out, pt, CONST_RKS256);
+    compare_block("AES-256 Flash Schedule Encryption", out, enc);
+    aes256_decrypt_P(dec, enc, CONST_DRKS256);
+    compare_block("AES-256 Flash Schedule Decryption", dec, pt);
+
+    aes_ecb_encrypt(out, msg, CONST_KEY, 24, 144);
+    aes_ecb_encrypt_P(out_P, msg, CONST_RKS192, 24, 144);
+    compare_block("AES-192 Flash Schedule ECB", out_P + 128, out + 128);
+    aes_ecb_decrypt_P(out_P, out, CONST_DRKS192, 24, 144);
+    compare_block("AES-192 Flash Schedule ECB Decryption", out_P + 16, msg + 16);
+
+    aes_ctr_encrypt(out, msg, CONST_KEY, 16, ctr, sizeof(msg));
+    aes_ctr_encrypt_P(out_P, msg, CONST_RKS128, 16, ctr, sizeof(msg));
+    compare_block("AES-128 Flash Schedule CTR", out_P + 136, out + 136);
+}
+
+/**
+ * Stored schedule against on-the-fly expansion, each including its key setup
+ */
+void aes128_otf_benchmark()
+{
+    const size_t blocks = 64;
+
+    uint8_t mk[16] = {0};
+    uint8_t block[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    uint8_t dk[16] = {0,};
+
+    long start = micros();
+    aes128_keygen(rks, mk);
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_encrypt(block, block, rks);
+    }
+    long elapsed_enc = micros() - start;
+
+    start = micros();
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_encrypt_otf(block, block, mk);
+    }
+    long elapsed_enc_otf = micros() - start;
+
+    start = micros();
+    aes128_keygen_decrypt(rks, mk);
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_decrypt(block, block, rks);
+    }
+    long elapsed_dec = micros() - start;
+
+    start = micros();
+    aes128_keygen_otf_decrypt(dk, mk);
+    for (size_t i = 0; i < blocks; ++i) {
+        aes128_decrypt_otf(block, block, dk);
+    }
+    long elapsed_dec_otf = micros() - start;
+
+    Serial.print("Key schedule bytes in RAM, stored: ");
+    Serial.println(RKS_SIZE);
+    Serial.println("Key schedule bytes in RAM, on-the-fly encryption: 0");
+    Serial.print("Key schedule bytes in RAM, on-the-fly decryption: ");
+    Serial.println(sizeof(dk));
+
+    print_cycles_per_byte("Stored schedule encryption cycles per byte: ", elapsed_enc, blocks * 16);
+    print_cycles_per_byte("On-the-fly encryption cycles per byte: ", elapsed_enc_otf, blocks * 16);
+    print_cycles_per_byte("Stored schedule decryption cycles per byte: ", elapsed_dec, blocks * 16);
+    print_cycles_per_byte("On-the-fly decryption cycles per byte: ", elapsed_dec_otf, blocks * 16);
+
+    for (size_t i = 0; i < 16; ++i) {
+        if (block[i] != 0) {
+            Serial.println("on-the-fly round trip failed");
+            break;
+        }
+    }
+
+    delay(1000);
+}
+
 void aes128_ecb_test() {
     const size_t length = 64;
   
@@ -137,10 +503,10 @@ void aes128_ecb_test() {
     uint8_t enc[length] = { 0 };
     uint8_t dec[length] = { 0 };
 
-    aes_ecb_encrypt(enc, pt, mk, length);
+    aes_ecb_encrypt(enc, pt, mk, sizeof(mk), length);
     print_hex("AES ECB ENCRYPTED", enc, length);
 
-    aes_ecb_decrypt(dec, enc, mk, length);
+    aes_ecb_decrypt(dec, enc, mk, sizeof(mk), length);
     print_hex("AES ECB DECRYPTED", dec, length);
     Serial.println();
 }
@@ -159,10 +525,448 @@ void aes128_ctr_test() {
     uint8_t enc[length] = { 0 };
     uint8_t dec[length] = { 0 };
 
-    aes_ctr_encrypt(enc, pt, mk, ctr, length);
+    aes_ctr_encrypt(enc, pt, mk, sizeof(mk), ctr, length);
     print_hex("AES CTR ENCRYPTED", enc, length);
 
-    aes_ctr_decrypt(dec, enc, mk, ctr, length);
+    aes_ctr_decrypt(dec, enc, mk, sizeof(mk), ctr, length);
     print_hex("AES CTR DECRYPTED", dec, length);
     Serial.println();
-}
\ No newline at end of file
+}
+
+static void report(const char* title, bool ok)
+{
+    Serial.println(title);
+    Serial.println(ok ? "passed" : "failed");
+    Serial.println();
+}
+
+/**
+ * Schedules stored in a blob and loaded back against keygen, and blobs the loader must refuse
+ */
+void aes_blob_test()
+{
+    uint8_t mk[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    uint8_t pt[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+    uint8_t enc[16] = {0};
+    uint8_t out[16] = {0};
+    uint8_t rks[AES_MAX_RKS_SIZE] = {0,};
+    uint32_t storage[AES_MAX_BLOB_SIZE / 4] = {0,};
+    uint8_t* blob = (uint8_t*) storage;
+
+    aes128_keygen(rks, mk);
+    size_t length = aes_blob_store(blob, rks, 16, AES_BLOB_ENCRYPT);
+    const uint8_t* loaded = aes_blob_load(blob, length, 16, AES_BLOB_ENCRYPT);
+    report("AES-128 Key Schedule Blob Size", length == AES_BLOB_SIZE(AES128_RKS_SIZE) && loaded != NULL);
+    aes128_encrypt(enc, pt, rks);
+    aes128_encrypt(out, pt, loaded != NULL ? loaded : rks);
+    compare_block("AES-128 Loaded Schedule Encryption", out, enc);
+
+    aes192_keygen(rks, mk);
+    length = aes_blob_store(blob, rks, 24, AES_BLOB_ENCRYPT);
+    loaded = aes_blob_load(blob, length, 24, AES_BLOB_ENCRYPT);
+    aes192_encrypt(enc, pt, rks);
+    aes192_encrypt(out, pt, loaded != NULL ? loaded : rks);
+    compare_block("AES-192 Loaded Schedule Encryption", out, enc);
+
+    aes256_keygen(rks, mk);
+    aes256_encrypt(enc, pt, rks);
+    aes256_keygen_decrypt(rks, mk);
+    length = aes_blob_store(blob, rks, 32, AES_BLOB_DECRYPT);
+    loaded = aes_blob_load(blob, length, 32, AES_BLOB_DECRYPT);
+    aes256_decrypt(out, enc, loaded != NULL ? loaded : rks);
+    compare_block("AES-256 Loaded Schedule Decryption", out, pt);
+
+    report("Key Schedule Blob for Another Key Size", aes_blob_load(blob, length, 16, AES_BLOB_DECRYPT) == NULL);
+    report("Key Schedule Blob for Another Direction", aes_blob_load(blob, length, 32, AES_BLOB_ENCRYPT) == NULL);
+    report("Truncated Key Schedule Blob", aes_blob_load(blob, length - 1, 32, AES_BLOB_DECRYPT) == NULL);
+
+    blob[2] += 1;
+    report("Key Schedule Blob of Another Version", aes_blob_load(blob, length, 32, AES_BLOB_DECRYPT) == NULL);
+    blob[2] -= 1;
+
+    blob[AES_BLOB_HEADER_SIZE + 100] ^= 0x01;
+    report("Corrupted Key Schedule Blob", aes_blob_load(blob, length, 32, AES_BLOB_DECRYPT) == NULL);
+}
+
+/**
+ * Time from power-up to the first encrypted 64-byte packet, expanding the key against loading
+ * a persisted schedule. The blob is read from a RAM copy standing in for EEPROM or a file.
+ */
+void aes128_blob_benchmark()
+{
+    const size_t starts = 16;
+    const size_t packet = 64;
+
+    uint8_t mk[16] = {0};
+    uint8_t msg[packet] = {0};
+    uint8_t rks[RKS_SIZE] = {0,};
+    uint32_t storage[AES_BLOB_SIZE(RKS_SIZE) / 4] = {0,};
+    uint32_t blob[AES_BLOB_SIZE(RKS_SIZE) / 4] = {0,};
+
+    aes128_keygen(rks, mk);
+    aes_blob_store((uint8_t*) storage, rks, 16, AES_BLOB_ENCRYPT);
+
+    long start = micros();
+    for (size_t n = 0; n < starts; ++n) {
+        aes128_keygen(rks, mk);
+        for (size_t i = 0; i < packet; i += 16) {
+            aes128_encrypt(msg + i, msg + i, rks);
+        }
+    }
+    long elapsed_keygen = micros() - start;
+
+    start = micros();
+    for (size_t n = 0; n < starts; ++n) {
+        memcpy(blob, storage, sizeof(blob));
+        const uint8_t* loaded = aes_blob_load((const uint8_t*) blob, sizeof(blob), 16, AES_BLOB_ENCRYPT);
+        for (size_t i = 0; i < packet; i += 16) {
+            aes128_encrypt(msg + i, msg + i, loaded);
+        }
+    }
+    long elapsed_blob = micros() - start;
+
+    Serial.print("Elapsed time for AES-128 16 cold starts to first 64-byte packet, keygen: ");
+    Serial.println(elapsed_keygen);
+    Serial.print("Elapsed time for AES-128 16 cold starts to first 64-byte packet, persisted schedule: ");
+    Serial.println(elapsed_blob);
+
+    delay(1000);
+}
+
+// CTR output of a mode call against counter blocks encrypted one at a time
+static bool check_ctr(const uint8_t* out, const uint8_t* msg, size_t length, const uint8_t* ctr,
+    void (*encrypt)(uint8_t*, const uint8_t*, const uint8_t*), const uint8_t* rks)
+{
+    uint8_t counter[16];
+    uint8_t block[16];
+    bool ok = true;
+
+    memcpy(counter, ctr, 16);
+    for (size_t i = 0; i < length; i += 16) {
+        encrypt(block, counter, rks);
+        for (size_t j = 0; j < 16 && i + j < length; ++j) {
+            ok = ok && (out[i + j] == (msg[i + j] ^ block[j]));
+        }
+
+        int idx = 15;
+        while (++counter[idx] == 0 && idx != 0) {
+            --idx;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * CTR runs across carries out of the last counter byte, first into byte 14 and then up to
+ * byte 11, where the cached rounds 1 and 2 of the table tiers have to be recomputed
+ */
+void aes_ctr_cache_test()
+{
+    const size_t length = 16 * 12 + 5;
+
+    uint8_t ctr[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xff, 0xfe, 0xfa};
+    uint8_t msg[length] = {0};
+    uint8_t out[length] = {0};
+    uint8_t rks[AES_MAX_RKS_SIZE] = {0,};
+
+    for (size_t i = 0; i < length; ++i) {
+        msg[i] = i * 5 + 3;
+    }
+
+    aes_ctr_encrypt(out, msg, CONST_KEY, 16, ctr, length);
+    aes128_keygen(rks, CONST_KEY);
+    report("AES-128 CTR cached rounds", check_ctr(out, msg, length, ctr, aes128_encrypt, rks));
+
+    aes_ctr_encrypt(out, msg, CONST_KEY, 24, ctr, length);
+    aes192_keygen(rks, CONST_KEY);
+    report("AES-192 CTR cached rounds", check_ctr(out, msg, length, ctr, aes192_encrypt, rks));
+
+    aes_ctr_encrypt(out, msg, CONST_KEY, 32, ctr, length);
+    aes256_keygen(rks, CONST_KEY);
+    report("AES-256 CTR cached rounds", check_ctr(out, msg, length, ctr, aes256_encrypt, rks));
+
+    aes_ctr_encrypt_P(out, msg, CONST_RKS128, 16, ctr, length);
+    report("AES-128 CTR cached rounds, schedule in AES_RKS_MEM", check_ctr(out, msg, length, ctr, aes128_encrypt_P, CONST_RKS128));
+}
+
+/**
+ * CTR keystream with the cached rounds against encrypting every counter block in full,
+ * on AES-NI and vector permute hosts the CTR function runs 8 blocks per call instead
+ */
+void aes128_ctr_benchmark()
+{
+    const size_t length = 1024;
+    static uint8_t buffer[length];
+
+    uint8_t mk[16] = {0};
+    uint8_t ctr[16] = {0};
+    uint8_t keystream[16] = {0};
+
+    uint8_t rks[RKS_SIZE] = {0,};
+    aes128_keygen(rks, mk);
+
+    long start = micros();
+    for (size_t i = 0; i < length; i += 16) {
+        aes128_encrypt(keystream, ctr, rks);
+        for (size_t j = 0; j < 16; ++j) {
+            buffer[i + j] ^= keystream[j];
+        }
+
+        int idx = 15;
+        while (++ctr[idx] == 0 && idx != 0) {
+            --idx;
+        }
+    }
+    long elapsed_plain = micros() - start;
+
+    memset(ctr, 0, sizeof(ctr));
+    start = micros();
+    aes128_encrypt_ctr(buffer, buffer, ctr, rks, length / 16);
+    long elapsed_cached = micros() - start;
+
+    print_cycles_per_byte("AES-128 CTR cycles per byte, block at a time: ", elapsed_plain, length);
+    print_cycles_per_byte("AES-128 CTR cycles per byte, encrypt_ctr: ", elapsed_cached, length);
+
+    for (size_t i = 0; i < length; ++i) {
+        if (buffer[i] != 0) {
+            Serial.println("CTR benchmark round trip failed");
+            break;
+        }
+    }
+
+    delay(1000);
+}
+
+static bool equal_bytes(const uint8_t* lhs, const uint8_t* rhs, size_t length)
+{
+    return memcmp(lhs, rhs, length) == 0;
+}
+
+/**
+ * Mode functions on a context against the ones taking the key, for every key size
+ */
+void aes_ctx_test()
+{
+    const size_t length = 16 * 10;
+    const size_t sizes[] = {16, 24, 32};
+
+    uint8_t ctr[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0xfa};
+    uint8_t msg[length] = {0};
+    uint8_t out[length] = {0};
+    uint8_t out_ctx[length] = {0};
+    uint8_t dec[length] = {0};
+
+    for (size_t i = 0; i < length; ++i) {
+        msg[i] = i * 3 + 11;
+    }
+
+    aes_ctx ctx;
+
+    for (size_t k = 0; k < 3; ++k) {
+        bool ok = aes_ctx_init(&ctx, CONST_KEY, sizes[k]);
+
+        aes_ecb_encrypt(out, msg, CONST_KEY, sizes[k], length);
+        aes_ecb_encrypt_ctx(out_ctx, msg, &ctx, length);
+        ok = ok && equal_bytes(out_ctx, out, length);
+
+        aes_ecb_decrypt_ctx(dec, out_ctx, &ctx, length);
+        ok = ok && equal_bytes(dec, msg, length);
+
+        aes_ctr_encrypt(out, msg, CONST_KEY, sizes[k], ctr, length - 7);
+        aes_ctr_encrypt_ctx(out_ctx, msg, &ctx, ctr, length - 7);
+        ok = ok && equal_bytes(out_ctx, out, length - 7);
+
+        aes_ctr_decrypt_ctx(dec, out_ctx, &ctx, ctr, length - 7);
+        ok = ok && equal_bytes(dec, msg, length - 7);
+
+        Serial.print("AES-");
+        Serial.print(sizes[k] * 8);
+        report(" ECB and CTR on a context", ok);
+    }
+
+    report("AES context with an unsupported key size", !aes_ctx_init(&ctx, CONST_KEY, 20));
+}
+
+/**
+ * Small CTR packets under one key, expanding the key on every call against a context set up once
+ */
+void aes128_ctx_benchmark()
+{
+    const size_t packets = 64;
+    const size_t packet = 32;
+
+    uint8_t mk[16] = {0};
+    uint8_t ctr[16] = {0};
+    uint8_t msg[packet] = {0};
+
+    long start = micros();
+    for (size_t n = 0; n < packets; ++n) {
+        ctr[15] = n;
+        aes_ctr_encrypt(msg, msg, mk, sizeof(mk), ctr, packet);
+    }
+    long elapsed_key = micros() - start;
+
+    aes_ctx ctx;
+    start = micros();
+    aes_ctx_init(&ctx, mk, sizeof(mk));
+    for (size_t n = 0; n < packets; ++n) {
+        ctr[15] = n;
+        aes_ctr_encrypt_ctx(msg, msg, &ctx, ctr, packet);
+    }
+    long elapsed_ctx = micros() - start;
+
+    Serial.print("Elapsed time for AES-128 CTR, 64 packets of 32 bytes, keygen per packet: ");
+    Serial.println(elapsed_key);
+    Serial.print("Elapsed time for AES-128 CTR, 64 packets of 32 bytes, one context: ");
+    Serial.println(elapsed_ctx);
+
+    delay(1000);
+}
+
+/**
+ * CBC against the NIST SP 800-38A F.2 vectors and against a chain of single block ECB calls,
+ * for every key size, decrypted out of place and in place; 19 blocks make two runs of the multi-block functions and three single blocks
+ */
+void aes_cbc_test()
+{
+    const size_t length = 16 * 19;
+    const size_t sizes[] = {16, 24, 32};
+
+    uint8_t iv[16] = {0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87, 0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f};
+    uint8_t msg[length] = {0};
+    uint8_t ref[length] = {0};
+    uint8_t out[length] = {0};
+    uint8_t dec[length] = {0};
+    uint8_t block[16] = {0};
+
+    // NIST SP 800-38A F.2.1, F.2.3 and F.2.5 share the iv and the plaintext
+    uint8_t kat_key128[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    uint8_t kat_key192[24] = {
+        0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52, 0xc8, 0x10, 0xf3, 0x2b, 0x80, 0x90, 0x79, 0xe5,
+        0x62, 0xf8, 0xea, 0xd2, 0x52, 0x2c, 0x6b, 0x7b,
+    };
+    uint8_t kat_key256[32] = {
+        0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+        0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4,
+    };
+    const uint8_t* kat_keys[] = {kat_key128, kat_key192, kat_key256};
+    uint8_t kat_iv[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    uint8_t kat_pt[64] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+    };
+    uint8_t kat_ct[3][64] = {
+        {
+            0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+            0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+            0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+            0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7,
+        },
+        {
+            0x4f, 0x02, 0x1d, 0xb2, 0x43, 0xbc, 0x63, 0x3d, 0x71, 0x78, 0x18, 0x3a, 0x9f, 0xa0, 0x71, 0xe8,
+            0xb4, 0xd9, 0xad, 0xa9, 0xad, 0x7d, 0xed, 0xf4, 0xe5, 0xe7, 0x38, 0x76, 0x3f, 0x69, 0x14, 0x5a,
+            0x57, 0x1b, 0x24, 0x20, 0x12, 0xfb, 0x7a, 0xe0, 0x7f, 0xa9, 0xba, 0xac, 0x3d, 0xf1, 0x02, 0xe0,
+            0x08, 0xb0, 0xe2, 0x79, 0x88, 0x59, 0x88, 0x81, 0xd9, 0x20, 0xa9, 0xe6, 0x4f, 0x56, 0x15, 0xcd,
+        },
+        {
+            0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba, 0x77, 0x9e, 0xab, 0xfb, 0x5f, 0x7b, 0xfb, 0xd6,
+            0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb, 0x80, 0x8d, 0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d,
+            0x39, 0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf, 0xa5, 0x30, 0xe2, 0x63, 0x04, 0x23, 0x14, 0x61,
+            0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc, 0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b,
+        },
+    };
+
+    for (size_t k = 0; k < 3; ++k) {
+        aes_cbc_encrypt(out, kat_pt, kat_keys[k], sizes[k], kat_iv, sizeof(kat_pt));
+        Serial.print("AES-");
+        Serial.print(sizes[k] * 8);
+        report(" CBC Encryption", equal_bytes(out, kat_ct[k], sizeof(kat_pt)));
+
+        aes_cbc_decrypt(dec, kat_ct[k], kat_keys[k], sizes[k], kat_iv, sizeof(kat_pt));
+        aes_cbc_decrypt(out, out, kat_keys[k], sizes[k], kat_iv, sizeof(kat_pt));
+        Serial.print("AES-");
+        Serial.print(sizes[k] * 8);
+        report(" CBC Decryption", equal_bytes(dec, kat_pt, sizeof(kat_pt)) && equal_bytes(out, kat_pt, sizeof(kat_pt)));
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        msg[i] = i * 7 + 5;
+    }
+
+    aes_ctx ctx;
+
+    for (size_t k = 0; k < 3; ++k) {
+        const uint8_t* chain = iv;
+        for (size_t i = 0; i < length; i += 16) {
+            for (size_t j = 0; j < 16; ++j) {
+                block[j] = msg[i + j] ^ chain[j];
+            }
+            aes_ecb_encrypt(ref + i, block, CONST_KEY, sizes[k], 16);
+            chain = ref + i;
+        }
+
+        aes_cbc_encrypt(out, msg, CONST_KEY, sizes[k], iv, length);
+        bool ok = equal_bytes(out, ref, length);
+
+        aes_cbc_decrypt(dec, out, CONST_KEY, sizes[k], iv, length);
+        ok = ok && equal_bytes(dec, msg, length);
+
+        aes_cbc_decrypt(out, out, CONST_KEY, sizes[k], iv, length);
+        ok = ok && equal_bytes(out, msg, length);
+
+        ok = ok && aes_ctx_init(&ctx, CONST_KEY, sizes[k]);
+        memcpy(out, msg, length);
+        aes_cbc_encrypt_ctx(out, out, &ctx, iv, length);
+        ok = ok && equal_bytes(out, ref, length);
+
+        aes_cbc_decrypt_ctx(out, out, &ctx, iv, length);
+        ok = ok && equal_bytes(out, msg, length);
+
+        Serial.print("AES-");
+        Serial.print(sizes[k] * 8);
+        report(" CBC against chained ECB", ok);
+    }
+
+    aes_cbc_encrypt(ref, msg, CONST_KEY, 16, iv, length);
+    aes_cbc_encrypt_P(out, msg, CONST_RKS128, 16, iv, length);
+    bool ok = equal_bytes(out, ref, length);
+
+    aes_cbc_decrypt_P(out, out, CONST_DRKS128, 16, iv, length);
+    report("AES-128 Flash Schedule CBC", ok && equal_bytes(out, msg, length));
+}
+
+void aes128_cbc_benchmark()
+{
+    const size_t length = 1024;
+    static uint8_t buffer[length];
+
+    uint8_t mk[16] = {0};
+    uint8_t iv[16] = {0};
+
+    aes_ctx ctx;
+    aes_ctx_init(&ctx, mk, sizeof(mk));
+
+    long start = micros();
+    aes_cbc_encrypt_ctx(buffer, buffer, &ctx, iv, length);
+    long elapsed_encrypt = micros() - start;
+
+    start = micros();
+    aes_cbc_decrypt_ctx(buffer, buffer, &ctx, iv, length);
+    long elapsed_decrypt = micros() - start;
+
+    print_cycles_per_byte("AES-128 CBC encryption cycles per byte: ", elapsed_encrypt, length);
+    print_cycles_per_byte("AES-128 CBC decryption cycles per byte: ", elapsed_decrypt, length);
+
+    for (size_t i = 0; i < length; ++i) {
+        if (buffer[i] != 0) {
+            Serial.println("CBC benchmark round trip failed");
+            break;
+        }
+    }
+
+    delay(1000);
+}
@@ -33,11 +33,29 @@ void setup() {
     Serial.begin(9600);
 
     aes128_encrypt_test();
+    aes128_decrypt_test();
+    aes192_test();
+    aes256_test();
+    aes_otf_test();
+    aes_const_keygen_test();
+    aes_blob_test();
+    aes128_encrypt8_test();
+    aes_ctr_cache_test();
+    aes_ctx_test();
+    aes_cbc_test();
 }
 
 void loop() {
     aes128_benchmark();
+    aes128_otf_benchmark();
+    aes128_blob_benchmark();
+    aes128_tier_benchmark();
+    aes128_bulk_benchmark();
+    aes128_ctr_benchmark();
+    aes128_ecb_test();
     aes128_ctr_test();
+    aes128_ctx_benchmark();
+    aes128_cbc_benchmark();
 
     delay(2000);
 }
@@ -30,6 +30,38 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 24, 28 or 32 rounds of six round key words, LEA_MAX_RKS_SIZE fits any of them
+#define LEA128_RKS_SIZE (24 * 24)
+#define LEA192_RKS_SIZE (28 * 24)
+#define LEA256_RKS_SIZE (32 * 24)
+#define LEA_MAX_RKS_SIZE LEA256_RKS_SIZE
+
+/**
+ * Schedules expanded ahead of time, such as the constexpr one from lea_const.h, are declared
+ * with LEA_RKS_MEM and passed to the _P functions. On AVR that puts them in flash, and the _P
+ * functions copy out one round key at a time; elsewhere they are ordinary read-only data.
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define LEA_RKS_MEM PROGMEM
+#else
+#define LEA_RKS_MEM
+#endif
+
 void lea128_keygen(uint8_t* out, const uint8_t* mk);
 void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
 void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+void lea192_keygen(uint8_t* out, const uint8_t* mk);
+void lea192_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+void lea256_keygen(uint8_t* out, const uint8_t* mk);
+void lea256_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
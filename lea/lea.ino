@@ -34,12 +34,20 @@ void setup() {
 
     lea128_encrypt_test();
     lea128_decrypt_test();
+    lea192_test();
+    lea256_test();
+    lea_const_keygen_test();
+    lea128_blob_test();
+    lea_ctx_test();
+    lea_cbc_test();
 }
 
 void loop() {
     lea128_benchmark();    
+    lea128_blob_benchmark();
     lea128_ecb_test();
     lea128_ctr_test();
+    lea128_ctx_benchmark();
 
     delay(2000);
 }
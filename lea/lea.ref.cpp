@@ -25,7 +25,6 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-
 #include "lea.h"
 #include <string.h>
 
@@ -38,19 +37,52 @@ const static uint32_t DELTA[8]= {
     0x715ea49e, 0xc785da0a, 0xe04ef22a, 0xe5c40957,
 };
 
+/**
+ * The block functions are templates on the round count, so each key size gets its own
+ * kernel with a constant trip count that the compiler unrolls completely.
+ */
+#if defined(__clang__)
+#define LEA_UNROLL _Pragma("clang loop unroll(full)")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define LEA_UNROLL _Pragma("GCC unroll 32")
+#else
+#define LEA_UNROLL
+#endif
+
+// the key schedules rotate by round + j, which reaches 0 and values past 31
 static inline uint32_t rol32(uint32_t value, size_t rot)
 {
-    return (value << rot) | (value >> (32 - rot));
+    return (value << (rot & 31)) | (value >> ((32 - rot) & 31));
 }
 
 static inline uint32_t ror32(uint32_t value, size_t rot)
 {
-    return (value >> rot) | (value << (32 - rot));
+    return (value >> (rot & 31)) | (value << ((32 - rot) & 31));
+}
+
+/**
+ * Round key words for one round. A schedule in flash on AVR is copied out a round at a time,
+ * otherwise the words are read in place.
+ */
+template <bool Flash>
+static inline const uint32_t* round_key(uint32_t* copy, const uint32_t* rk)
+{
+#if defined(__AVR__)
+    if (Flash) {
+        memcpy_P(copy, rk, 24);
+        return copy;
+    }
+#else
+    (void) copy;
+#endif
+    return rk;
 }
 
-static inline void lea_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t rounds)
+template <size_t Rounds, bool Flash>
+static inline void lea_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
 {
     const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t copy[6];
     const uint32_t* block = (const uint32_t*) in;
     uint32_t* outblk = (uint32_t*) out;
 
@@ -59,11 +91,13 @@ static inline void lea_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* r
     uint32_t b2 = block[2];
     uint32_t b3 = block[3];
 
-    for (size_t round = 0; round < rounds; round += 1)
+    LEA_UNROLL
+    for (size_t round = 0; round < Rounds; round += 1)
     {
-        b3 = ror32((b2 ^ rk[4]) + (b3 ^ rk[5]), 3);
-        b2 = ror32((b1 ^ rk[2]) + (b2 ^ rk[3]), 5);
-        b1 = rol32((b0 ^ rk[0]) + (b1 ^ rk[1]), 9);
+        const uint32_t* k = round_key<Flash>(copy, rk);
+        b3 = ror32((b2 ^ k[4]) + (b3 ^ k[5]), 3);
+        b2 = ror32((b1 ^ k[2]) + (b2 ^ k[3]), 5);
+        b1 = rol32((b0 ^ k[0]) + (b1 ^ k[1]), 9);
         rk += 6;
 
         uint32_t tmp = b0;
@@ -79,9 +113,11 @@ static inline void lea_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* r
     outblk[3] = b3;
 }
 
-static inline void lea_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t rounds)
+template <size_t Rounds, bool Flash>
+static inline void lea_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
 {
     const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t copy[6];
     const uint32_t* block = (const uint32_t*) in;
     uint32_t* outblk = (uint32_t*) out;
 
@@ -90,12 +126,14 @@ static inline void lea_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* r
     uint32_t b2 = block[2];
     uint32_t b3 = block[3];
 
-    rk += 6 * (rounds - 1);
-    for (size_t round = 0; round < rounds; round += 1)
+    rk += 6 * (Rounds - 1);
+    LEA_UNROLL
+    for (size_t round = 0; round < Rounds; round += 1)
     {
-        b0 = (ror32(b0, 9) - (b3 ^ rk[0])) ^ rk[1];
-        b1 = (rol32(b1, 5) - (b0 ^ rk[2])) ^ rk[3];
-        b2 = (rol32(b2, 3) - (b1 ^ rk[4])) ^ rk[5];
+        const uint32_t* k = round_key<Flash>(copy, rk);
+        b0 = (ror32(b0, 9) - (b3 ^ k[0])) ^ k[1];
+        b1 = (rol32(b1, 5) - (b0 ^ k[2])) ^ k[3];
+        b2 = (rol32(b2, 3) - (b1 ^ k[4])) ^ k[5];
         rk -= 6;
 
         uint32_t tmp = b3;
@@ -144,10 +182,119 @@ void lea128_keygen(uint8_t* out, const uint8_t* mk)
 
 void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
 {
-    lea_encrypt(out, in, rks, LEA128_ROUNDS);
+    lea_encrypt<LEA128_ROUNDS, false>(out, in, rks);
 }
 
 void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
 {
-    lea_decrypt(out, in, rks, LEA128_ROUNDS);
+    lea_decrypt<LEA128_ROUNDS, false>(out, in, rks);
+}
+
+void lea128_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+void lea128_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+/**
+ * LEA 128-bit block, 192-bit key: six key words, each its own round key word
+ */
+void lea192_keygen(uint8_t* out, const uint8_t* mk)
+{
+    const uint32_t* t = (const uint32_t*) mk;
+    uint32_t* rk = (uint32_t*) out;
+
+    uint32_t t0 = t[0];
+    uint32_t t1 = t[1];
+    uint32_t t2 = t[2];
+    uint32_t t3 = t[3];
+    uint32_t t4 = t[4];
+    uint32_t t5 = t[5];
+
+    for(size_t round = 0; round < LEA192_ROUNDS; ++round) {
+        uint32_t delta = DELTA[round % 6];
+
+        t0 = rol32(t0 + rol32(delta, round), 1);
+        t1 = rol32(t1 + rol32(delta, round + 1), 3);
+        t2 = rol32(t2 + rol32(delta, round + 2), 6);
+        t3 = rol32(t3 + rol32(delta, round + 3), 11);
+        t4 = rol32(t4 + rol32(delta, round + 4), 13);
+        t5 = rol32(t5 + rol32(delta, round + 5), 17);
+
+        rk[0] = t0;
+        rk[1] = t1;
+        rk[2] = t2;
+        rk[3] = t3;
+        rk[4] = t4;
+        rk[5] = t5;
+        rk += 6;
+    }
+}
+
+void lea192_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA192_ROUNDS, false>(out, in, rks);
+}
+
+void lea192_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA192_ROUNDS, false>(out, in, rks);
+}
+
+void lea192_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA192_ROUNDS, true>(out, in, rks);
+}
+
+void lea192_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA192_ROUNDS, true>(out, in, rks);
+}
+
+/**
+ * LEA 128-bit block, 256-bit key: every round updates six of the eight key words,
+ * starting where the previous round stopped
+ */
+void lea256_keygen(uint8_t* out, const uint8_t* mk)
+{
+    const size_t rot[6] = {1, 3, 6, 11, 13, 17};
+    uint32_t t[8];
+    uint32_t* rk = (uint32_t*) out;
+
+    memcpy(t, mk, 32);
+
+    for(size_t round = 0; round < LEA256_ROUNDS; ++round) {
+        uint32_t delta = DELTA[round & 7];
+
+        for (size_t j = 0; j < 6; ++j) {
+            size_t idx = (6 * round + j) & 7;
+            t[idx] = rol32(t[idx] + rol32(delta, round + j), rot[j]);
+            rk[j] = t[idx];
+        }
+        rk += 6;
+    }
+}
+
+void lea256_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA256_ROUNDS, false>(out, in, rks);
+}
+
+void lea256_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA256_ROUNDS, false>(out, in, rks);
+}
+
+void lea256_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA256_ROUNDS, true>(out, in, rks);
+}
+
+void lea256_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA256_ROUNDS, true>(out, in, rks);
 }
@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lea.h"
+
+/**
+ * Compile-time LEA key schedules for devices that keep one key for their whole life.
+ * With the key in a constexpr array,
+ *
+ *     constexpr uint8_t DEVICE_KEY[16] = { ... };
+ *     const uint8_t DEVICE_RKS[LEA128_RKS_SIZE] LEA_RKS_MEM = { LEA128_KEYGEN_CONST(DEVICE_KEY) };
+ *
+ * the compiler expands the schedule into flash, where the _P block and mode functions read it
+ * without running keygen. The result is byte for byte what lea128_keygen writes, and the same
+ * holds for LEA192_KEYGEN_CONST and LEA256_KEYGEN_CONST.
+ * Written as single-expression recursions so that they stay valid C++11.
+ */
+static constexpr uint32_t LEA_DELTA_CONST[8] = {
+    0xc3efe9db, 0x44626b02, 0x79e27c8a, 0x78df30ec,
+    0x715ea49e, 0xc785da0a, 0xe04ef22a, 0xe5c40957,
+};
+
+// rotation by 0 returns the value instead of shifting by 32
+constexpr uint32_t lea_rol_const(uint32_t value, size_t rot)
+{
+    return rot % 32 == 0 ? value : (uint32_t) ((value << (rot % 32)) | (value >> (32 - rot % 32)));
+}
+
+constexpr uint32_t lea_key_word_const(const uint8_t* mk, size_t j)
+{
+    return (uint32_t) mk[4 * j] ^ ((uint32_t) mk[4 * j + 1] << 8) ^ ((uint32_t) mk[4 * j + 2] << 16) ^ ((uint32_t) mk[4 * j + 3] << 24);
+}
+
+// the j-th word updated in a round is rotated left by 1, 3, 6, 11, 13 and 17
+constexpr size_t lea_t_rot_const(size_t j)
+{
+    return j == 0 ? 1 : j == 1 ? 3 : j == 2 ? 6 : j == 3 ? 11 : j == 4 ? 13 : 17;
+}
+
+/**
+ * Position j at which T[idx] is updated in the given round, 6 or more when it is left alone.
+ * With nk = 4 or 6 every word is updated in every round; with nk = 8 a round updates six
+ * words, starting where the previous round stopped.
+ */
+constexpr size_t lea_t_step_const(size_t nk, size_t idx, size_t round)
+{
+    return nk == 8 ? (idx + 8 - (6 * round) % 8) % 8 : idx;
+}
+
+// T[idx] of a key of nk words after the given round
+constexpr uint32_t lea_t_const(const uint8_t* mk, size_t nk, size_t idx, size_t round)
+{
+    return lea_t_step_const(nk, idx, round) >= 6
+        ? (round == 0 ? lea_key_word_const(mk, idx) : lea_t_const(mk, nk, idx, round - 1))
+        : lea_rol_const((round == 0 ? lea_key_word_const(mk, idx) : lea_t_const(mk, nk, idx, round - 1))
+            + lea_rol_const(LEA_DELTA_CONST[round % nk], round + lea_t_step_const(nk, idx, round)), lea_t_rot_const(lea_t_step_const(nk, idx, round)));
+}
+
+// LEA-128 round keys are T[0], T[1], T[2], T[1], T[3], T[1]; LEA-192 uses T[0..5] and LEA-256 the six words just updated
+constexpr size_t lea_rk_index_const(size_t nk, size_t round, size_t k)
+{
+    return nk == 4 ? (k == 0 ? 0 : k == 2 ? 2 : k == 4 ? 3 : 1) : nk == 6 ? k : (6 * round + k) % 8;
+}
+
+constexpr uint8_t lea_rk_byte_const(const uint8_t* mk, size_t nk, size_t index)
+{
+    return (uint8_t) (lea_t_const(mk, nk, lea_rk_index_const(nk, index / 24, (index % 24) / 4), index / 24) >> (8 * (index % 4)));
+}
+
+#define LEA_RKS_CONST_ROUND(mk, nk, r) \
+    lea_rk_byte_const(mk, nk, 24 * (r) +  0), lea_rk_byte_const(mk, nk, 24 * (r) +  1), \
+    lea_rk_byte_const(mk, nk, 24 * (r) +  2), lea_rk_byte_const(mk, nk, 24 * (r) +  3), \
+    lea_rk_byte_const(mk, nk, 24 * (r) +  4), lea_rk_byte_const(mk, nk, 24 * (r) +  5), \
+    lea_rk_byte_const(mk, nk, 24 * (r) +  6), lea_rk_byte_const(mk, nk, 24 * (r) +  7), \
+    lea_rk_byte_const(mk, nk, 24 * (r) +  8), lea_rk_byte_const(mk, nk, 24 * (r) +  9), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 10), lea_rk_byte_const(mk, nk, 24 * (r) + 11), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 12), lea_rk_byte_const(mk, nk, 24 * (r) + 13), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 14), lea_rk_byte_const(mk, nk, 24 * (r) + 15), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 16), lea_rk_byte_const(mk, nk, 24 * (r) + 17), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 18), lea_rk_byte_const(mk, nk, 24 * (r) + 19), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 20), lea_rk_byte_const(mk, nk, 24 * (r) + 21), \
+    lea_rk_byte_const(mk, nk, 24 * (r) + 22), lea_rk_byte_const(mk, nk, 24 * (r) + 23)
+
+#define LEA_RKS_CONST_ROUNDS_0_23(mk, nk) \
+    LEA_RKS_CONST_ROUND(mk, nk, 0), LEA_RKS_CONST_ROUND(mk, nk, 1), LEA_RKS_CONST_ROUND(mk, nk, 2), LEA_RKS_CONST_ROUND(mk, nk, 3), \
+    LEA_RKS_CONST_ROUND(mk, nk, 4), LEA_RKS_CONST_ROUND(mk, nk, 5), LEA_RKS_CONST_ROUND(mk, nk, 6), LEA_RKS_CONST_ROUND(mk, nk, 7), \
+    LEA_RKS_CONST_ROUND(mk, nk, 8), LEA_RKS_CONST_ROUND(mk, nk, 9), LEA_RKS_CONST_ROUND(mk, nk, 10), LEA_RKS_CONST_ROUND(mk, nk, 11), \
+    LEA_RKS_CONST_ROUND(mk, nk, 12), LEA_RKS_CONST_ROUND(mk, nk, 13), LEA_RKS_CONST_ROUND(mk, nk, 14), LEA_RKS_CONST_ROUND(mk, nk, 15), \
+    LEA_RKS_CONST_ROUND(mk, nk, 16), LEA_RKS_CONST_ROUND(mk, nk, 17), LEA_RKS_CONST_ROUND(mk, nk, 18), LEA_RKS_CONST_ROUND(mk, nk, 19), \
+    LEA_RKS_CONST_ROUND(mk, nk, 20), LEA_RKS_CONST_ROUND(mk, nk, 21), LEA_RKS_CONST_ROUND(mk, nk, 22), LEA_RKS_CONST_ROUND(mk, nk, 23)
+
+#define LEA128_KEYGEN_CONST(mk) \
+    LEA_RKS_CONST_ROUNDS_0_23(mk, 4)
+
+#define LEA192_KEYGEN_CONST(mk) \
+    LEA_RKS_CONST_ROUNDS_0_23(mk, 6), \
+    LEA_RKS_CONST_ROUND(mk, 6, 24), LEA_RKS_CONST_ROUND(mk, 6, 25), LEA_RKS_CONST_ROUND(mk, 6, 26), LEA_RKS_CONST_ROUND(mk, 6, 27)
+
+#define LEA256_KEYGEN_CONST(mk) \
+    LEA_RKS_CONST_ROUNDS_0_23(mk, 8), \
+    LEA_RKS_CONST_ROUND(mk, 8, 24), LEA_RKS_CONST_ROUND(mk, 8, 25), LEA_RKS_CONST_ROUND(mk, 8, 26), LEA_RKS_CONST_ROUND(mk, 8, 27), \
+    LEA_RKS_CONST_ROUND(mk, 8, 28), LEA_RKS_CONST_ROUND(mk, 8, 29), LEA_RKS_CONST_ROUND(mk, 8, 30), LEA_RKS_CONST_ROUND(mk, 8, 31)
@@ -26,96 +26,251 @@
  */
 
 #include "lea.h"
+#include "lea_mode.h"
+#include <block_mode.h>
 #include "HardwareSerial.h"
 
-const size_t RKS_SIZE = 24 * 24;
+typedef mode_cipher<16, LEA128_RKS_SIZE, LEA128_RKS_SIZE, lea128_keygen, lea128_keygen, lea128_encrypt, lea128_decrypt> LEA128;
+typedef mode_cipher<24, LEA192_RKS_SIZE, LEA192_RKS_SIZE, lea192_keygen, lea192_keygen, lea192_encrypt, lea192_decrypt> LEA192;
+typedef mode_cipher<32, LEA256_RKS_SIZE, LEA256_RKS_SIZE, lea256_keygen, lea256_keygen, lea256_encrypt, lea256_decrypt> LEA256;
 
-void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+// the same on a schedule in LEA_RKS_MEM
+typedef mode_cipher<16, LEA128_RKS_SIZE, LEA128_RKS_SIZE, lea128_keygen, lea128_keygen, lea128_encrypt_P, lea128_decrypt_P> LEA128_P;
+typedef mode_cipher<24, LEA192_RKS_SIZE, LEA192_RKS_SIZE, lea192_keygen, lea192_keygen, lea192_encrypt_P, lea192_decrypt_P> LEA192_P;
+typedef mode_cipher<32, LEA256_RKS_SIZE, LEA256_RKS_SIZE, lea256_keygen, lea256_keygen, lea256_encrypt_P, lea256_decrypt_P> LEA256_P;
+
+static const mode_table* select_cipher(size_t keysize)
+{
+    switch (keysize) {
+    case 16:
+        return &mode_table_of<LEA128, LEA128_P>::table;
+    case 24:
+        return &mode_table_of<LEA192, LEA192_P>::table;
+    case 32:
+        return &mode_table_of<LEA256, LEA256_P>::table;
+    }
+
+    Serial.println("key size is not 16, 24 or 32");
+    return NULL;
+}
+
+static bool check_length(size_t length)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
+    if (length % 16 != 0) {
         Serial.println("length is not multiple of 16");
-        return; 
+        return false;
     }
+    return true;
+}
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
 
-    while (length > 0) {
-        lea128_encrypt(out, in, rks);
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+    mode_table_read(cipher, ecb_encrypt_key)(out, in, key, length);
+}
+
+void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, ecb_decrypt_key)(out, in, key, length);
 }
 
-void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
-        Serial.println("length is not multiple of 16");
-        return; 
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, ctr_encrypt_key)(out, in, key, ctr, length);
+}
+
+void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    lea_ctr_encrypt(out, in, key, keysize, ctr, length);  
+}
+
+void lea_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_encrypt_key)(out, in, key, iv, length);
+}
+
+void lea_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_decrypt_key)(out, in, key, iv, length);
+}
+
+void lea_ecb_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+    mode_table_read(cipher, ecb_encrypt_P)(out, in, rks, length);
+}
 
-    while (length > 0) {
-        lea128_decrypt(out, in, rks);
+void lea_ecb_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, ecb_decrypt_P)(out, in, rks, length);
 }
 
-static void xor_bytes(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs, size_t length)
+void lea_ctr_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
 {
-    for (int i = 0; i < length; ++i) {
-      out[i] = lhs[i] ^ rhs[i];
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, ctr_encrypt_P)(out, in, rks, ctr, length);
 }
 
-static void increase_counter(uint8_t* ctr_copy, size_t blocksize)
+void lea_ctr_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
 {
-    int idx = blocksize - 1;
-    while ( (++ctr_copy[idx]) == 0 && idx != 0) {
-        --idx;
+    lea_ctr_encrypt_P(out, in, rks, keysize, ctr, length);
+}
+
+void lea_cbc_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_encrypt_P)(out, in, rks, iv, length);
 }
 
-void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+void lea_cbc_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
 {
-    const size_t blocksize = 16;
+    if (!check_length(length)) {
+        return;
+    }
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-    uint8_t keystream[blocksize] = {0};
-    uint8_t ctr_copy[blocksize] = {0};
+    mode_table_read(cipher, cbc_decrypt_P)(out, in, rks, iv, length);
+}
 
-    memcpy(ctr_copy, ctr, blocksize);
+bool lea_ctx_init(lea_ctx* ctx, const uint8_t* key, size_t keysize)
+{
+    ctx->cipher = select_cipher(keysize);
+    if (ctx->cipher == NULL) {
+        return false;
+    }
 
-    while (length >= blocksize) {
-        lea128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, blocksize);
-        increase_counter(ctr_copy, blocksize);
+    mode_table_read(ctx->cipher, keygen)(ctx->rks, key);
+    return true;
+}
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+static bool check_ctx(const lea_ctx* ctx)
+{
+    if (ctx->cipher == NULL) {
+        Serial.println("context is not initialized");
+        return false;
     }
+    return true;
+}
 
-    if (length > 0) {
-        lea128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, length);
+void lea_ecb_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
     }
+
+    mode_table_read(ctx->cipher, ecb_encrypt)(out, in, ctx->rks, length);
 }
 
-void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+void lea_ecb_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length)
 {
-    lea_ctr_encrypt(out, in, key, ctr, length);  
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ecb_decrypt)(out, in, ctx->rks, length);
+}
+
+void lea_ctr_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    if (!check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ctr_encrypt)(out, in, ctx->rks, ctr, length);
+}
+
+void lea_ctr_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    lea_ctr_encrypt_ctx(out, in, ctx, ctr, length);
+}
+
+void lea_cbc_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, cbc_encrypt)(out, in, ctx->rks, iv, length);
+}
+
+void lea_cbc_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, cbc_decrypt)(out, in, ctx->rks, iv, length);
 }
@@ -28,9 +28,52 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#include "lea.h"
 
-void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length);
-void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length);
+struct mode_table;
 
-void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length);
-void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length);
+/**
+ * Keyed context for many messages under one key: lea_ctx_init expands the schedule once and
+ * the _ctx mode functions only do block work.
+ *
+ * The schedule is sized for LEA-256 whatever the key: on AVR the context takes 770 bytes of
+ * SRAM, over a third of an Uno's 2 KB, of which LEA-128 uses 578.
+ */
+struct lea_ctx {
+    const mode_table* cipher;
+    uint8_t rks[LEA_MAX_RKS_SIZE];
+};
+
+// keysize is the key length in bytes: 16, 24 or 32
+void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length);
+void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length);
+
+void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length);
+void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length);
+
+// out may be in itself, otherwise the two must not overlap
+void lea_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length);
+void lea_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length);
+
+// rks is a schedule in LEA_RKS_MEM, e.g. baked with LEA128_KEYGEN_CONST from lea_const.h
+void lea_ecb_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length);
+void lea_ecb_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length);
+
+void lea_ctr_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length);
+void lea_ctr_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length);
+
+void lea_cbc_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length);
+void lea_cbc_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length);
+
+// false when keysize is not 16, 24 or 32, the context is then unusable
+bool lea_ctx_init(lea_ctx* ctx, const uint8_t* key, size_t keysize);
+
+void lea_ecb_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length);
+void lea_ecb_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length);
+
+void lea_ctr_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length);
+void lea_ctr_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length);
+
+void lea_cbc_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length);
+void lea_cbc_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length);
\ No newline at end of file
@@ -28,6 +28,8 @@
 #include "lea_test.h"
 #include "lea.h"
 #include "lea_mode.h"
+#include "lea_const.h"
+#include "lea_blob.h"
 #include "Arduino.h"
 
 static const size_t RKS_SIZE = 24 * 24;
@@ -123,6 +125,55 @@ void lea128_decrypt_test() {
     compare_block("LEA-128 Decryption", dec, pt);
 }
 
+void lea192_test()
+{
+    uint8_t mk[] = {0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0, 0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87};
+    uint8_t pt[] = {0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f};
+    uint8_t ct[] = {0x6f, 0xb9, 0x5e, 0x32, 0x5a, 0xad, 0x1b, 0x87, 0x8c, 0xdc, 0xf5, 0x35, 0x76, 0x74, 0xc6, 0xf2};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+
+    uint8_t rks[LEA192_RKS_SIZE] = {0,};
+    lea192_keygen(rks, mk);
+
+    lea192_encrypt(enc, pt, rks);
+    compare_block("LEA-192 Encryption", enc, ct);
+
+    lea192_decrypt(dec, ct, rks);
+    compare_block("LEA-192 Decryption", dec, pt);
+}
+
+void lea256_test()
+{
+    uint8_t mk[] = {0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0, 0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87, 0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f};
+    uint8_t pt[] = {0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f};
+    uint8_t ct[] = {0xd6, 0x51, 0xaf, 0xf6, 0x47, 0xb1, 0x89, 0xc1, 0x3a, 0x89, 0x00, 0xca, 0x27, 0xf9, 0xe1, 0x97};
+
+    uint8_t enc[16] = {0};
+    uint8_t dec[16] = {0};
+
+    uint8_t rks[LEA256_RKS_SIZE] = {0,};
+    lea256_keygen(rks, mk);
+
+    lea256_encrypt(enc, pt, rks);
+    compare_block("LEA-256 Encryption", enc, ct);
+
+    lea256_decrypt(dec, ct, rks);
+    compare_block("LEA-256 Decryption", dec, pt);
+
+    uint8_t msg[48] = {0};
+    uint8_t out[48] = {0};
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = pt[i % 16];
+    }
+
+    lea_ecb_encrypt(out, msg, mk, 32, sizeof(msg));
+    compare_block("LEA-256 ECB", out + 32, ct);
+    lea_ecb_decrypt(out, out, mk, 32, sizeof(msg));
+    compare_block("LEA-256 ECB Decryption", out + 16, pt);
+}
+
 void lea128_ecb_test() {
     const size_t length = 64;
   
@@ -136,10 +187,10 @@ void lea128_ecb_test() {
     uint8_t enc[length] = { 0 };
     uint8_t dec[length] = { 0 };
 
-    lea_ecb_encrypt(enc, pt, mk, length);
+    lea_ecb_encrypt(enc, pt, mk, 16, length);
     print_hex("LEA-128 ECB ENCRYPTED", enc, length);
 
-    lea_ecb_decrypt(dec, enc, mk, length);
+    lea_ecb_decrypt(dec, enc, mk, 16, length);
     print_hex("LEA-128 ECB DECRYPTED", dec, length);
     Serial.println();
 }
@@ -158,10 +209,331 @@ void lea128_ctr_test() {
     uint8_t enc[length] = { 0 };
     uint8_t dec[length] = { 0 };
 
-    lea_ctr_encrypt(enc, pt, mk, ctr, length);
+    lea_ctr_encrypt(enc, pt, mk, 16, ctr, length);
     print_hex("LEA-128 CTR ENCRYPTED", enc, length);
 
-    lea_ctr_decrypt(dec, enc, mk, ctr, length);
+    lea_ctr_decrypt(dec, enc, mk, 16, ctr, length);
     print_hex("LEA-128 CTR DECRYPTED", dec, length);
     Serial.println();
-}
\ No newline at end of file
+}
+
+static constexpr uint8_t CONST_KEY[32] = {0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0, 0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87, 0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f};
+static const uint8_t CONST_RKS128[LEA128_RKS_SIZE] LEA_RKS_MEM = { LEA128_KEYGEN_CONST(CONST_KEY) };
+static const uint8_t CONST_RKS192[LEA192_RKS_SIZE] LEA_RKS_MEM = { LEA192_KEYGEN_CONST(CONST_KEY) };
+static const uint8_t CONST_RKS256[LEA256_RKS_SIZE] LEA_RKS_MEM = { LEA256_KEYGEN_CONST(CONST_KEY) };
+
+static void compare_const_schedule(const char* title, const uint8_t* rks_P, const uint8_t* rks, size_t size)
+{
+    uint8_t copy[LEA_MAX_RKS_SIZE] = {0,};
+#if defined(__AVR__)
+    memcpy_P(copy, rks_P, size);
+#else
+    memcpy(copy, rks_P, size);
+#endif
+
+    for (size_t i = 0; i < size; i += 16) {
+        if (memcmp(copy + i, rks + i, 16) != 0) {
+            compare_block(title, copy + i, rks + i);
+            return;
+        }
+    }
+    compare_block(title, copy, rks);
+}
+
+/**
+ * Schedules baked at compile time against keygen, and the _P functions on them against the
+ * key-based ones
+ */
+void lea_const_keygen_test()
+{
+    uint8_t pt[] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    uint8_t ct[] = {0x9f, 0xc8, 0x4e, 0x35, 0x28, 0xc6, 0xc6, 0x18, 0x55, 0x32, 0xc7, 0xa7, 0x04, 0x64, 0x8b, 0xfd};
+    uint8_t ctr[] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+    uint8_t msg[40] = {0};
+    uint8_t out[40] = {0};
+    uint8_t out_P[40] = {0};
+
+    uint8_t enc[16] = {0};
+    uint8_t rks[LEA_MAX_RKS_SIZE] = {0,};
+
+    for (size_t i = 0; i < sizeof(msg); ++i) {
+        msg[i] = i;
+    }
+
+    lea128_keygen(rks, CONST_KEY);
+    compare_const_schedule("LEA-128 Compile-time Key Schedule", CONST_RKS128, rks, LEA128_RKS_SIZE);
+    lea128_encrypt_P(out, pt, CONST_RKS128);
+    compare_block("LEA-128 Flash Schedule Encryption", out, ct);
+    lea128_decrypt_P(out, ct, CONST_RKS128);
+    compare_block("LEA-128 Flash Schedule Decryption", out, pt);
+
+    lea192_keygen(rks, CONST_KEY);
+    compare_const_schedule("LEA-192 Compile-time Key Schedule", CONST_RKS192, rks, LEA192_RKS_SIZE);
+    lea192_encrypt(enc, pt, rks);
+    lea192_encrypt_P(out, pt, CONST_RKS192);
+    compare_block("LEA-192 Flash Schedule Encryption", out, enc);
+    lea192_decrypt_P(out, enc, CONST_RKS192);
+    compare_block("LEA-192 Flash Schedule Decryption", out, pt);
+
+    lea256_keygen(rks, CONST_KEY);
+    compare_const_schedule("LEA-256 Compile-time Key Schedule", CONST_RKS256, rks, LEA256_RKS_SIZE);
+    lea256_encrypt(enc, pt, rks);
+    lea256_encrypt_P(out, pt, CONST_RKS256);
+    compare_block("LEA-256 Flash Schedule Encryption", out, enc);
+    lea256_decrypt_P(out, enc, CONST_RKS256);
+    compare_block("LEA-256 Flash Schedule Decryption", out, pt);
+
+    lea_ecb_encrypt(out, msg, CONST_KEY, 16, 32);
+    lea_ecb_encrypt_P(out_P, msg, CONST_RKS128, 16, 32);
+    compare_block("LEA-128 Flash Schedule ECB", out_P + 16, out + 16);
+
+    lea_ctr_encrypt(out, msg, CONST_KEY, 32, ctr, sizeof(msg));
+    lea_ctr_encrypt_P(out_P, msg, CONST_RKS256, 32, ctr, sizeof(msg));
+    compare_block("LEA-256 Flash Schedule CTR", out_P + 24, out + 24);
+}
+
+static void report(const char* title, bool ok)
+{
+    Serial.println(title);
+    Serial.println(ok ? "passed" : "failed");
+    Serial.println();
+}
+
+/**
+ * A schedule stored in a blob and loaded back against keygen, and blobs the loader must refuse
+ */
+void lea128_blob_test()
+{
+    uint8_t mk[] = {0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78, 0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0};
+    uint8_t pt[] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    uint8_t ct[] = {0x9f, 0xc8, 0x4e, 0x35, 0x28, 0xc6, 0xc6, 0x18, 0x55, 0x32, 0xc7, 0xa7, 0x04, 0x64, 0x8b, 0xfd};
+
+    uint8_t out[16] = {0};
+    uint8_t rks[RKS_SIZE] = {0,};
+    uint32_t storage[LEA_BLOB_SIZE(RKS_SIZE) / 4] = {0,};
+    uint8_t* blob = (uint8_t*) storage;
+
+    lea128_keygen(rks, mk);
+    size_t length = lea_blob_store(blob, rks, 16);
+    const uint8_t* loaded = lea_blob_load(blob, length, 16);
+    report("LEA-128 Key Schedule Blob Size", length == LEA_BLOB_SIZE(RKS_SIZE) && loaded != NULL);
+
+    lea128_encrypt(out, pt, loaded != NULL ? loaded : rks);
+    compare_block("LEA-128 Loaded Schedule Encryption", out, ct);
+
+    report("Key Schedule Blob for Another Key Size", lea_blob_load(blob, length, 32) == NULL);
+
+    uint32_t storage256[LEA_MAX_BLOB_SIZE / 4] = {0,};
+    uint8_t rks256[LEA256_RKS_SIZE] = {0,};
+    uint8_t mk256[32] = {0};
+    uint8_t enc[16] = {0};
+
+    memcpy(mk256, mk, 16);
+    lea256_keygen(rks256, mk256);
+    lea256_encrypt(enc, pt, rks256);
+    size_t length256 = lea_blob_store((uint8_t*) storage256, rks256, 32);
+    loaded = lea_blob_load((const uint8_t*) storage256, length256, 32);
+    lea256_decrypt(out, enc, loaded != NULL ? loaded : rks256);
+    compare_block("LEA-256 Loaded Schedule Decryption", out, pt);
+    report("Truncated Key Schedule Blob", lea_blob_load(blob, length - 1, 16) == NULL);
+
+    blob[2] += 1;
+    report("Key Schedule Blob of Another Version", lea_blob_load(blob, length, 16) == NULL);
+    blob[2] -= 1;
+
+    blob[LEA_BLOB_HEADER_SIZE + 100] ^= 0x01;
+    report("Corrupted Key Schedule Blob", lea_blob_load(blob, length, 16) == NULL);
+}
+
+/**
+ * Time from power-up to the first encrypted 64-byte packet, expanding the key against loading
+ * a persisted schedule. The blob is read from a RAM copy standing in for EEPROM or a file.
+ */
+void lea128_blob_benchmark()
+{
+    const size_t starts = 16;
+    const size_t packet = 64;
+
+    uint8_t mk[16] = {0};
+    uint8_t msg[packet] = {0};
+    uint8_t rks[RKS_SIZE] = {0,};
+    uint32_t storage[LEA_BLOB_SIZE(RKS_SIZE) / 4] = {0,};
+    uint32_t blob[LEA_BLOB_SIZE(RKS_SIZE) / 4] = {0,};
+
+    lea128_keygen(rks, mk);
+    lea_blob_store((uint8_t*) storage, rks, 16);
+
+    long start = micros();
+    for (size_t n = 0; n < starts; ++n) {
+        lea128_keygen(rks, mk);
+        for (size_t i = 0; i < packet; i += 16) {
+            lea128_encrypt(msg + i, msg + i, rks);
+        }
+    }
+    long elapsed_keygen = micros() - start;
+
+    start = micros();
+    for (size_t n = 0; n < starts; ++n) {
+        memcpy(blob, storage, sizeof(blob));
+        const uint8_t* loaded = lea_blob_load((const uint8_t*) blob, sizeof(blob), 16);
+        for (size_t i = 0; i < packet; i += 16) {
+            lea128_encrypt(msg + i, msg + i, loaded);
+        }
+    }
+    long elapsed_blob = micros() - start;
+
+    Serial.print("Elapsed time for LEA-128 16 cold starts to first 64-byte packet, keygen: ");
+    Serial.println(elapsed_keygen);
+    Serial.print("Elapsed time for LEA-128 16 cold starts to first 64-byte packet, persisted schedule: ");
+    Serial.println(elapsed_blob);
+
+    delay(1000);
+}
+
+static bool equal_bytes(const uint8_t* lhs, const uint8_t* rhs, size_t length)
+{
+    return memcmp(lhs, rhs, length) == 0;
+}
+
+/**
+ * Mode functions on a context against the ones taking the key, for every key size
+ */
+void lea_ctx_test()
+{
+    const size_t length = 16 * 10;
+    const size_t sizes[] = {16, 24, 32};
+
+    uint8_t ctr[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0xfa};
+    uint8_t msg[length] = {0};
+    uint8_t out[length] = {0};
+    uint8_t out_ctx[length] = {0};
+    uint8_t dec[length] = {0};
+
+    for (size_t i = 0; i < length; ++i) {
+        msg[i] = i * 3 + 11;
+    }
+
+    lea_ctx ctx;
+
+    for (size_t k = 0; k < 3; ++k) {
+        bool ok = lea_ctx_init(&ctx, CONST_KEY, sizes[k]);
+
+        lea_ecb_encrypt(out, msg, CONST_KEY, sizes[k], length);
+        lea_ecb_encrypt_ctx(out_ctx, msg, &ctx, length);
+        ok = ok && equal_bytes(out_ctx, out, length);
+
+        lea_ecb_decrypt_ctx(dec, out_ctx, &ctx, length);
+        ok = ok && equal_bytes(dec, msg, length);
+
+        lea_ctr_encrypt(out, msg, CONST_KEY, sizes[k], ctr, length - 7);
+        lea_ctr_encrypt_ctx(out_ctx, msg, &ctx, ctr, length - 7);
+        ok = ok && equal_bytes(out_ctx, out, length - 7);
+
+        lea_ctr_decrypt_ctx(dec, out_ctx, &ctx, ctr, length - 7);
+        ok = ok && equal_bytes(dec, msg, length - 7);
+
+        Serial.print("LEA-");
+        Serial.print(sizes[k] * 8);
+        report(" ECB and CTR on a context", ok);
+    }
+
+    report("LEA context with an unsupported key size", !lea_ctx_init(&ctx, CONST_KEY, 20));
+}
+
+/**
+ * Small CTR packets under one key, expanding the key on every call against a context set up once
+ */
+void lea128_ctx_benchmark()
+{
+    const size_t packets = 64;
+    const size_t packet = 32;
+
+    uint8_t mk[16] = {0};
+    uint8_t ctr[16] = {0};
+    uint8_t msg[packet] = {0};
+
+    long start = micros();
+    for (size_t n = 0; n < packets; ++n) {
+        ctr[15] = n;
+        lea_ctr_encrypt(msg, msg, mk, sizeof(mk), ctr, packet);
+    }
+    long elapsed_key = micros() - start;
+
+    lea_ctx ctx;
+    start = micros();
+    lea_ctx_init(&ctx, mk, sizeof(mk));
+    for (size_t n = 0; n < packets; ++n) {
+        ctr[15] = n;
+        lea_ctr_encrypt_ctx(msg, msg, &ctx, ctr, packet);
+    }
+    long elapsed_ctx = micros() - start;
+
+    Serial.print("Elapsed time for LEA-128 CTR, 64 packets of 32 bytes, keygen per packet: ");
+    Serial.println(elapsed_key);
+    Serial.print("Elapsed time for LEA-128 CTR, 64 packets of 32 bytes, one context: ");
+    Serial.println(elapsed_ctx);
+
+    delay(1000);
+}
+
+/**
+ * CBC against a chain of single block ECB calls for every key size, decrypted out of place and
+ * in place; 19 blocks make two runs of the multi-block functions and three single blocks
+ */
+void lea_cbc_test()
+{
+    const size_t length = 16 * 19;
+    const size_t sizes[] = {16, 24, 32};
+
+    uint8_t iv[16] = {0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87, 0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f};
+    uint8_t msg[length] = {0};
+    uint8_t ref[length] = {0};
+    uint8_t out[length] = {0};
+    uint8_t dec[length] = {0};
+    uint8_t block[16] = {0};
+
+    for (size_t i = 0; i < length; ++i) {
+        msg[i] = i * 7 + 5;
+    }
+
+    lea_ctx ctx;
+
+    for (size_t k = 0; k < 3; ++k) {
+        const uint8_t* chain = iv;
+        for (size_t i = 0; i < length; i += 16) {
+            for (size_t j = 0; j < 16; ++j) {
+                block[j] = msg[i + j] ^ chain[j];
+            }
+            lea_ecb_encrypt(ref + i, block, CONST_KEY, sizes[k], 16);
+            chain = ref + i;
+        }
+
+        lea_cbc_encrypt(out, msg, CONST_KEY, sizes[k], iv, length);
+        bool ok = equal_bytes(out, ref, length);
+
+        lea_cbc_decrypt(dec, out, CONST_KEY, sizes[k], iv, length);
+        ok = ok && equal_bytes(dec, msg, length);
+
+        lea_cbc_decrypt(out, out, CONST_KEY, sizes[k], iv, length);
+        ok = ok && equal_bytes(out, msg, length);
+
+        ok = ok && lea_ctx_init(&ctx, CONST_KEY, sizes[k]);
+        memcpy(out, msg, length);
+        lea_cbc_encrypt_ctx(out, out, &ctx, iv, length);
+        ok = ok && equal_bytes(out, ref, length);
+
+        lea_cbc_decrypt_ctx(out, out, &ctx, iv, length);
+        ok = ok && equal_bytes(out, msg, length);
+
+        Serial.print("LEA-");
+        Serial.print(sizes[k] * 8);
+        report(" CBC against chained ECB", ok);
+    }
+
+    lea_cbc_encrypt(ref, msg, CONST_KEY, 16, iv, length);
+    lea_cbc_encrypt_P(out, msg, CONST_RKS128, 16, iv, length);
+    bool ok = equal_bytes(out, ref, length);
+
+    lea_cbc_decrypt_P(out, out, CONST_RKS128, 16, iv, length);
+    report("LEA-128 Flash Schedule CBC", ok && equal_bytes(out, msg, length));
+}
@@ -33,6 +33,14 @@
 void print_hex(const char* title, const uint8_t* data, size_t count);
 void lea128_encrypt_test();
 void lea128_decrypt_test();
+void lea192_test();
+void lea256_test();
+void lea_const_keygen_test();
+void lea128_blob_test();
+void lea128_blob_benchmark();
 void lea128_benchmark();
 void lea128_ecb_test();
-void lea128_ctr_test();
\ No newline at end of file
+void lea128_ctr_test();
+void lea_ctx_test();
+void lea128_ctx_benchmark();
+void lea_cbc_test();
\ No newline at end of file
@@ -30,6 +30,112 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 24, 28 or 32 rounds of six round key words, LEA_MAX_RKS_SIZE fits any of them
+#define LEA128_RKS_SIZE (24 * 24)
+#define LEA192_RKS_SIZE (28 * 24)
+#define LEA256_RKS_SIZE (32 * 24)
+#define LEA_MAX_RKS_SIZE LEA256_RKS_SIZE
+#define LEA_MAX_KEY_SIZE 32
+
+// LEA-128 schedule with four words per round, see lea128_keygen_compact
+#define LEA128_COMPACT_RKS_SIZE (24 * 16)
+
+/**
+ * Rounds per loop iteration of the block kernels: 1, 2, 4 or LEA_UNROLL_FULL for all of them.
+ * Larger factors trade flash for speed, the default of 4 already keeps the words in place.
+ */
+#define LEA_UNROLL_FULL 0
+#ifndef LEA_UNROLL
+#define LEA_UNROLL 4
+#endif
+
+#if LEA_UNROLL != 1 && LEA_UNROLL != 2 && LEA_UNROLL != 4 && LEA_UNROLL != LEA_UNROLL_FULL
+#error "LEA_UNROLL must be 1, 2, 4 or LEA_UNROLL_FULL"
+#endif
+
+// blocks processed by one call to the multi-block functions
+#define LEA_BULK_BLOCKS 8
+
+/**
+ * Schedules expanded ahead of time, such as the constexpr one from lea_const.h, are declared
+ * with LEA_RKS_MEM and passed to the _P functions. On AVR that puts them in flash, and the _P
+ * functions copy out one round key at a time; elsewhere they are ordinary read-only data.
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define LEA_RKS_MEM PROGMEM
+#else
+#define LEA_RKS_MEM
+#endif
+
+/**
+ * The encrypt_ctr functions xor blocks whole CTR keystream blocks into out and advance the
+ * big endian counter ctr past them. Rounds 1 and 2 of a counter block are cached for as long
+ * as only its last four bytes change.
+ */
 void lea128_keygen(uint8_t* out, const uint8_t* mk);
 void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
 void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea128_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea128_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+// LEA-128 encryption with a given unroll factor for benchmarks: 1, 2, 4 or LEA_UNROLL_FULL
+void lea128_encrypt_unroll(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t unroll);
+
+/**
+ * Compact LEA-128 schedule: each round stores T0, T1, T2, T3 instead of the six words
+ * T0, T1, T2, T1, T3, T1, 384 bytes instead of 576. Only the _compact functions read it;
+ * the _P functions, lea_const.h and lea_blob.h keep the six word layout.
+ */
+void lea128_keygen_compact(uint8_t* out, const uint8_t* mk);
+void lea128_encrypt_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_decrypt_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_encrypt8_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_decrypt8_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea128_encrypt_ctr_compact(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+
+void lea192_keygen(uint8_t* out, const uint8_t* mk);
+void lea192_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea192_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea192_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea192_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+void lea256_keygen(uint8_t* out, const uint8_t* mk);
+void lea256_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea256_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+void lea256_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+void lea256_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+/**
+ * On-the-fly key schedule: the key words are advanced one round at a time while the block is
+ * processed, so no schedule is stored. Encryption reads the key itself. Decryption starts from
+ * dk, the key words after the last round as made by keygen_otf_decrypt, and steps the schedule
+ * backwards. dk is as long as the key. Define LEA_ON_THE_FLY to make the ECB and CTR modes use
+ * these functions.
+ */
+void lea128_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void lea128_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk);
+void lea128_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk);
+
+void lea192_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void lea192_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk);
+void lea192_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk);
+
+void lea256_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk);
+void lea256_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk);
+void lea256_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk);
+
+// backend the multi-block functions run on: AVX2, SSE2 or the scalar kernel
+const char* lea_backend_name();
@@ -0,0 +1,322 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "lea_opt.h"
+
+#if defined(LEA_SIMD)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+bool lea_sse2_available()
+{
+    static int available = -1;
+
+    if (available < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        available = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    }
+
+    return available != 0;
+}
+
+// AVX2 also needs the OS to save the upper halves of the ymm registers, which XCR0 reports
+bool lea_avx2_available()
+{
+    static int available = -1;
+
+    if (available < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        available = 0;
+
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+            unsigned int xcr0, xcr0_hi;
+            __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0_hi) : "c" (0));
+
+            available = ((xcr0 & 0x6) == 0x6)
+                && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+        }
+    }
+
+    return available != 0;
+}
+
+/**
+ * 4 x 4 word transpose: four blocks in, one vector per block word out, lane i holding block i.
+ * It is its own inverse, so it also turns the words back into blocks.
+ */
+LEA_SSE2_TARGET static inline void transpose(__m128i& x0, __m128i& x1, __m128i& x2, __m128i& x3)
+{
+    __m128i t0 = _mm_unpacklo_epi32(x0, x1);
+    __m128i t1 = _mm_unpacklo_epi32(x2, x3);
+    __m128i t2 = _mm_unpackhi_epi32(x0, x1);
+    __m128i t3 = _mm_unpackhi_epi32(x2, x3);
+
+    x0 = _mm_unpacklo_epi64(t0, t1);
+    x1 = _mm_unpackhi_epi64(t0, t1);
+    x2 = _mm_unpacklo_epi64(t2, t3);
+    x3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+template <int Rot>
+LEA_SSE2_TARGET static inline __m128i rol(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi32(value, Rot), _mm_srli_epi32(value, 32 - Rot));
+}
+
+LEA_SSE2_TARGET static inline __m128i key_xor(__m128i value, uint32_t rk)
+{
+    return _mm_xor_si128(value, _mm_set1_epi32(rk));
+}
+
+/**
+ * One round on four blocks. The words are passed by reference and shifted one place, so four
+ * consecutive calls leave them where they started and the compiler drops the moves.
+ */
+template <bool Compact>
+LEA_SSE2_TARGET static inline void encrypt_round(__m128i& b0, __m128i& b1, __m128i& b2, __m128i& b3, const uint32_t* k)
+{
+    typedef lea_rk_layout<Compact> L;
+    __m128i t = b0;
+
+    b0 = rol<9>(_mm_add_epi32(key_xor(b0, k[0]), key_xor(b1, k[1])));
+    b1 = rol<27>(_mm_add_epi32(key_xor(b1, k[2]), key_xor(b2, k[L::k3])));
+    b2 = rol<29>(_mm_add_epi32(key_xor(b2, k[L::k4]), key_xor(b3, k[L::k5])));
+    b3 = t;
+}
+
+template <bool Compact>
+LEA_SSE2_TARGET static inline void decrypt_round(__m128i& b0, __m128i& b1, __m128i& b2, __m128i& b3, const uint32_t* k)
+{
+    typedef lea_rk_layout<Compact> L;
+    __m128i x0 = b3;
+    __m128i x1 = key_xor(_mm_sub_epi32(rol<23>(b0), key_xor(x0, k[0])), k[1]);
+    __m128i x2 = key_xor(_mm_sub_epi32(rol<5>(b1), key_xor(x1, k[2])), k[L::k3]);
+    __m128i x3 = key_xor(_mm_sub_epi32(rol<3>(b2), key_xor(x2, k[L::k4])), k[L::k5]);
+
+    b0 = x0;
+    b1 = x1;
+    b2 = x2;
+    b3 = x3;
+}
+
+template <size_t Rounds, bool Compact>
+LEA_SSE2_TARGET void lea_sse2_encrypt4(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    const size_t words = lea_rk_layout<Compact>::words;
+    const uint32_t* rk = (const uint32_t*) rks;
+
+    __m128i b0 = _mm_loadu_si128((const __m128i*) in + 0);
+    __m128i b1 = _mm_loadu_si128((const __m128i*) in + 1);
+    __m128i b2 = _mm_loadu_si128((const __m128i*) in + 2);
+    __m128i b3 = _mm_loadu_si128((const __m128i*) in + 3);
+    transpose(b0, b1, b2, b3);
+
+    for (size_t round = 0; round < Rounds; round += 4) {
+        encrypt_round<Compact>(b0, b1, b2, b3, rk);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + words);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + 2 * words);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + 3 * words);
+        rk += 4 * words;
+    }
+
+    transpose(b0, b1, b2, b3);
+    _mm_storeu_si128((__m128i*) out + 0, b0);
+    _mm_storeu_si128((__m128i*) out + 1, b1);
+    _mm_storeu_si128((__m128i*) out + 2, b2);
+    _mm_storeu_si128((__m128i*) out + 3, b3);
+}
+
+template <size_t Rounds, bool Compact>
+LEA_SSE2_TARGET void lea_sse2_decrypt4(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    const size_t words = lea_rk_layout<Compact>::words;
+    const uint32_t* rk = (const uint32_t*) rks + words * Rounds;
+
+    __m128i b0 = _mm_loadu_si128((const __m128i*) in + 0);
+    __m128i b1 = _mm_loadu_si128((const __m128i*) in + 1);
+    __m128i b2 = _mm_loadu_si128((const __m128i*) in + 2);
+    __m128i b3 = _mm_loadu_si128((const __m128i*) in + 3);
+    transpose(b0, b1, b2, b3);
+
+    for (size_t round = 0; round < Rounds; round += 4) {
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 2 * words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 3 * words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 4 * words);
+        rk -= 4 * words;
+    }
+
+    transpose(b0, b1, b2, b3);
+    _mm_storeu_si128((__m128i*) out + 0, b0);
+    _mm_storeu_si128((__m128i*) out + 1, b1);
+    _mm_storeu_si128((__m128i*) out + 2, b2);
+    _mm_storeu_si128((__m128i*) out + 3, b3);
+}
+
+/**
+ * The AVX2 kernels run the same transpose in both 128-bit halves, the low half holding
+ * blocks 0 to 3 and the high half blocks 4 to 7
+ */
+LEA_AVX2_TARGET static inline void transpose(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    __m256i t1 = _mm256_unpacklo_epi32(x2, x3);
+    __m256i t2 = _mm256_unpackhi_epi32(x0, x1);
+    __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    x0 = _mm256_unpacklo_epi64(t0, t1);
+    x1 = _mm256_unpackhi_epi64(t0, t1);
+    x2 = _mm256_unpacklo_epi64(t2, t3);
+    x3 = _mm256_unpackhi_epi64(t2, t3);
+}
+
+// blocks i and i + 4 share a vector, one per 128-bit half
+LEA_AVX2_TARGET static inline __m256i load_pair(const uint8_t* in, size_t i)
+{
+    __m128i lo = _mm_loadu_si128((const __m128i*) in + i);
+    __m128i hi = _mm_loadu_si128((const __m128i*) in + i + 4);
+
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+LEA_AVX2_TARGET static inline void store_pair(uint8_t* out, size_t i, __m256i value)
+{
+    _mm_storeu_si128((__m128i*) out + i, _mm256_castsi256_si128(value));
+    _mm_storeu_si128((__m128i*) out + i + 4, _mm256_extracti128_si256(value, 1));
+}
+
+template <int Rot>
+LEA_AVX2_TARGET static inline __m256i rol(__m256i value)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(value, Rot), _mm256_srli_epi32(value, 32 - Rot));
+}
+
+LEA_AVX2_TARGET static inline __m256i key_xor(__m256i value, uint32_t rk)
+{
+    return _mm256_xor_si256(value, _mm256_set1_epi32(rk));
+}
+
+template <bool Compact>
+LEA_AVX2_TARGET static inline void encrypt_round(__m256i& b0, __m256i& b1, __m256i& b2, __m256i& b3, const uint32_t* k)
+{
+    typedef lea_rk_layout<Compact> L;
+    __m256i t = b0;
+
+    b0 = rol<9>(_mm256_add_epi32(key_xor(b0, k[0]), key_xor(b1, k[1])));
+    b1 = rol<27>(_mm256_add_epi32(key_xor(b1, k[2]), key_xor(b2, k[L::k3])));
+    b2 = rol<29>(_mm256_add_epi32(key_xor(b2, k[L::k4]), key_xor(b3, k[L::k5])));
+    b3 = t;
+}
+
+template <bool Compact>
+LEA_AVX2_TARGET static inline void decrypt_round(__m256i& b0, __m256i& b1, __m256i& b2, __m256i& b3, const uint32_t* k)
+{
+    typedef lea_rk_layout<Compact> L;
+    __m256i x0 = b3;
+    __m256i x1 = key_xor(_mm256_sub_epi32(rol<23>(b0), key_xor(x0, k[0])), k[1]);
+    __m256i x2 = key_xor(_mm256_sub_epi32(rol<5>(b1), key_xor(x1, k[2])), k[L::k3]);
+    __m256i x3 = key_xor(_mm256_sub_epi32(rol<3>(b2), key_xor(x2, k[L::k4])), k[L::k5]);
+
+    b0 = x0;
+    b1 = x1;
+    b2 = x2;
+    b3 = x3;
+}
+
+template <size_t Rounds, bool Compact>
+LEA_AVX2_TARGET void lea_avx2_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    const size_t words = lea_rk_layout<Compact>::words;
+    const uint32_t* rk = (const uint32_t*) rks;
+
+    __m256i b0 = load_pair(in, 0);
+    __m256i b1 = load_pair(in, 1);
+    __m256i b2 = load_pair(in, 2);
+    __m256i b3 = load_pair(in, 3);
+    transpose(b0, b1, b2, b3);
+
+    for (size_t round = 0; round < Rounds; round += 4) {
+        encrypt_round<Compact>(b0, b1, b2, b3, rk);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + words);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + 2 * words);
+        encrypt_round<Compact>(b0, b1, b2, b3, rk + 3 * words);
+        rk += 4 * words;
+    }
+
+    transpose(b0, b1, b2, b3);
+    store_pair(out, 0, b0);
+    store_pair(out, 1, b1);
+    store_pair(out, 2, b2);
+    store_pair(out, 3, b3);
+}
+
+template <size_t Rounds, bool Compact>
+LEA_AVX2_TARGET void lea_avx2_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    const size_t words = lea_rk_layout<Compact>::words;
+    const uint32_t* rk = (const uint32_t*) rks + words * Rounds;
+
+    __m256i b0 = load_pair(in, 0);
+    __m256i b1 = load_pair(in, 1);
+    __m256i b2 = load_pair(in, 2);
+    __m256i b3 = load_pair(in, 3);
+    transpose(b0, b1, b2, b3);
+
+    for (size_t round = 0; round < Rounds; round += 4) {
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 2 * words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 3 * words);
+        decrypt_round<Compact>(b0, b1, b2, b3, rk - 4 * words);
+        rk -= 4 * words;
+    }
+
+    transpose(b0, b1, b2, b3);
+    store_pair(out, 0, b0);
+    store_pair(out, 1, b1);
+    store_pair(out, 2, b2);
+    store_pair(out, 3, b3);
+}
+
+template void lea_sse2_encrypt4<LEA128_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_encrypt4<LEA192_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_encrypt4<LEA256_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_encrypt4<LEA128_ROUNDS, true>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_decrypt4<LEA128_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_decrypt4<LEA192_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_decrypt4<LEA256_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_sse2_decrypt4<LEA128_ROUNDS, true>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_encrypt8<LEA128_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_encrypt8<LEA192_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_encrypt8<LEA256_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_encrypt8<LEA128_ROUNDS, true>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_decrypt8<LEA128_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_decrypt8<LEA192_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_decrypt8<LEA256_ROUNDS, false>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template void lea_avx2_decrypt8<LEA128_ROUNDS, true>(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+
+#endif
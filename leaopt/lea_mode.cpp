@@ -26,96 +26,289 @@
  */
 
 #include "lea.h"
+#include "lea_mode.h"
+#include <block_mode.h>
 #include "HardwareSerial.h"
 
-const size_t RKS_SIZE = 24 * 24;
+#if defined(LEA_ON_THE_FLY)
+/**
+ * Key words are advanced inside every block call: encryption reads the key directly,
+ * so keygen only copies it, and decryption keeps only the key words after the last round.
+ * There are no multi-block on-the-fly functions, blocks go one at a time.
+ */
+typedef mode_cipher<16, 16, 16, mode_copy_key<16>, lea128_keygen_otf_decrypt, lea128_encrypt_otf, lea128_decrypt_otf> LEA128;
+typedef mode_cipher<24, 24, 24, mode_copy_key<24>, lea192_keygen_otf_decrypt, lea192_encrypt_otf, lea192_decrypt_otf> LEA192;
+typedef mode_cipher<32, 32, 32, mode_copy_key<32>, lea256_keygen_otf_decrypt, lea256_encrypt_otf, lea256_decrypt_otf> LEA256;
+#else
+// LEA-128 expands keys into the compact schedule; the _P functions take the six word one from lea_const.h or lea_blob.h
+typedef mode_cipher<16, LEA128_COMPACT_RKS_SIZE, LEA128_COMPACT_RKS_SIZE, lea128_keygen_compact, lea128_keygen_compact, lea128_encrypt_compact, lea128_decrypt_compact,
+                    mode_ctr_kernel<lea128_encrypt_ctr_compact>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea128_encrypt8_compact, lea128_decrypt8_compact> > LEA128;
+typedef mode_cipher<24, LEA192_RKS_SIZE, LEA192_RKS_SIZE, lea192_keygen, lea192_keygen, lea192_encrypt, lea192_decrypt,
+                    mode_ctr_kernel<lea192_encrypt_ctr>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea192_encrypt8, lea192_decrypt8> > LEA192;
+typedef mode_cipher<32, LEA256_RKS_SIZE, LEA256_RKS_SIZE, lea256_keygen, lea256_keygen, lea256_encrypt, lea256_decrypt,
+                    mode_ctr_kernel<lea256_encrypt_ctr>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea256_encrypt8, lea256_decrypt8> > LEA256;
+#endif
+
+#if defined(__AVR__)
+// the same on a schedule in LEA_RKS_MEM, which is flash here: only the _P functions read it
+typedef mode_cipher<16, LEA128_RKS_SIZE, LEA128_RKS_SIZE, lea128_keygen, lea128_keygen, lea128_encrypt_P, lea128_decrypt_P, mode_ctr_kernel<lea128_encrypt_ctr_P> > LEA128_P;
+typedef mode_cipher<24, LEA192_RKS_SIZE, LEA192_RKS_SIZE, lea192_keygen, lea192_keygen, lea192_encrypt_P, lea192_decrypt_P, mode_ctr_kernel<lea192_encrypt_ctr_P> > LEA192_P;
+typedef mode_cipher<32, LEA256_RKS_SIZE, LEA256_RKS_SIZE, lea256_keygen, lea256_keygen, lea256_encrypt_P, lea256_decrypt_P, mode_ctr_kernel<lea256_encrypt_ctr_P> > LEA256_P;
+#else
+// the same on a schedule in LEA_RKS_MEM, which is RAM here: the multi-block functions read it in place
+typedef mode_cipher<16, LEA128_RKS_SIZE, LEA128_RKS_SIZE, lea128_keygen, lea128_keygen, lea128_encrypt_P, lea128_decrypt_P,
+                    mode_ctr_kernel<lea128_encrypt_ctr_P>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea128_encrypt8, lea128_decrypt8> > LEA128_P;
+typedef mode_cipher<24, LEA192_RKS_SIZE, LEA192_RKS_SIZE, lea192_keygen, lea192_keygen, lea192_encrypt_P, lea192_decrypt_P,
+                    mode_ctr_kernel<lea192_encrypt_ctr_P>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea192_encrypt8, lea192_decrypt8> > LEA192_P;
+typedef mode_cipher<32, LEA256_RKS_SIZE, LEA256_RKS_SIZE, lea256_keygen, lea256_keygen, lea256_encrypt_P, lea256_decrypt_P,
+                    mode_ctr_kernel<lea256_encrypt_ctr_P>, mode_bulk_kernel<LEA_BULK_BLOCKS, lea256_encrypt8, lea256_decrypt8> > LEA256_P;
+#endif
 
-void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+static const mode_table* select_cipher(size_t keysize)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
+    switch (keysize) {
+    case 16:
+        return &mode_table_of<LEA128, LEA128_P>::table;
+    case 24:
+        return &mode_table_of<LEA192, LEA192_P>::table;
+    case 32:
+        return &mode_table_of<LEA256, LEA256_P>::table;
+    }
+
+    Serial.println("key size is not 16, 24 or 32");
+    return NULL;
+}
+
+static bool check_length(size_t length)
+{
+    if (length % 16 != 0) {
         Serial.println("length is not multiple of 16");
-        return; 
+        return false;
+    }
+    return true;
+}
+
+void lea_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+    mode_table_read(cipher, ecb_encrypt_key)(out, in, key, length);
+}
 
-    while (length > 0) {
-        lea128_encrypt(out, in, rks);
+void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, ecb_decrypt_key)(out, in, key, length);
 }
 
-void lea_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
 {
-    const size_t blocksize = 16;
-    if (length % blocksize != 0)
-    {
-        Serial.println("length is not multiple of 16");
-        return; 
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+    mode_table_read(cipher, ctr_encrypt_key)(out, in, key, ctr, length);
+}
+
+void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    lea_ctr_encrypt(out, in, key, keysize, ctr, length);  
+}
 
-    while (length > 0) {
-        lea128_decrypt(out, in, rks);
+void lea_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
+    }
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, cbc_encrypt_key)(out, in, key, iv, length);
 }
 
-static void xor_bytes(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs, size_t length)
+void lea_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t keysize, const uint8_t* iv, size_t length)
 {
-    for (int i = 0; i < length; ++i) {
-      out[i] = lhs[i] ^ rhs[i];
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, cbc_decrypt_key)(out, in, key, iv, length);
 }
 
-static void increase_counter(uint8_t* ctr_copy, size_t blocksize)
+void lea_ecb_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
 {
-    int idx = blocksize - 1;
-    while ( (++ctr_copy[idx]) == 0 && idx != 0) {
-        --idx;
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, ecb_encrypt_P)(out, in, rks, length);
 }
 
-void lea_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+void lea_ecb_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, size_t length)
 {
-    const size_t blocksize = 16;
+    if (!check_length(length)) {
+        return;
+    }
 
-    uint8_t rks[RKS_SIZE] = {0,};
-    lea128_keygen(rks, key);
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-    uint8_t keystream[blocksize] = {0};
-    uint8_t ctr_copy[blocksize] = {0};
+    mode_table_read(cipher, ecb_decrypt_P)(out, in, rks, length);
+}
 
-    memcpy(ctr_copy, ctr, blocksize);
+void lea_ctr_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
 
-    while (length >= blocksize) {
-        lea128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, blocksize);
-        increase_counter(ctr_copy, blocksize);
+    mode_table_read(cipher, ctr_encrypt_P)(out, in, rks, ctr, length);
+}
 
-        in += blocksize;
-        out += blocksize;
-        length -= blocksize;
+void lea_ctr_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* ctr, size_t length)
+{
+    lea_ctr_encrypt_P(out, in, rks, keysize, ctr, length);
+}
+
+void lea_cbc_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length)) {
+        return;
     }
 
-    if (length > 0) {
-        lea128_encrypt(keystream, ctr_copy, rks);
-        xor_bytes(out, in, keystream, length);
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
     }
+
+    mode_table_read(cipher, cbc_encrypt_P)(out, in, rks, iv, length);
 }
 
-void lea_ctr_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+void lea_cbc_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t keysize, const uint8_t* iv, size_t length)
 {
-    lea_ctr_encrypt(out, in, key, ctr, length);  
+    if (!check_length(length)) {
+        return;
+    }
+
+    const mode_table* cipher = select_cipher(keysize);
+    if (cipher == NULL) {
+        return;
+    }
+
+    mode_table_read(cipher, cbc_decrypt_P)(out, in, rks, iv, length);
+}
+
+bool lea_ctx_init(lea_ctx* ctx, const uint8_t* key, size_t keysize)
+{
+    ctx->cipher = select_cipher(keysize);
+    if (ctx->cipher == NULL) {
+        return false;
+    }
+
+    mode_table_read(ctx->cipher, keygen)(ctx->rks, key);
+#if defined(LEA_ON_THE_FLY)
+    mode_table_read(ctx->cipher, keygen_decrypt)(ctx->drks, key);
+#endif
+    return true;
+}
+
+// on the fly decryption starts from the schedule tail, otherwise one schedule serves both directions
+static const uint8_t* decrypt_rks(const lea_ctx* ctx)
+{
+#if defined(LEA_ON_THE_FLY)
+    return ctx->drks;
+#else
+    return ctx->rks;
+#endif
+}
+
+static bool check_ctx(const lea_ctx* ctx)
+{
+    if (ctx->cipher == NULL) {
+        Serial.println("context is not initialized");
+        return false;
+    }
+    return true;
+}
+
+void lea_ecb_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ecb_encrypt)(out, in, ctx->rks, length);
+}
+
+void lea_ecb_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ecb_decrypt)(out, in, decrypt_rks(ctx), length);
+}
+
+void lea_ctr_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    if (!check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, ctr_encrypt)(out, in, ctx->rks, ctr, length);
+}
+
+void lea_ctr_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* ctr, size_t length)
+{
+    lea_ctr_encrypt_ctx(out, in, ctx, ctr, length);
+}
+
+void lea_cbc_encrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, cbc_encrypt)(out, in, ctx->rks, iv, length);
+}
+
+void lea_cbc_decrypt_ctx(uint8_t* out, const uint8_t* in, const lea_ctx* ctx, const uint8_t* iv, size_t length)
+{
+    if (!check_length(length) || !check_ctx(ctx)) {
+        return;
+    }
+
+    mode_table_read(ctx->cipher, cbc_decrypt)(out, in, decrypt_rks(ctx), iv, length);
 }
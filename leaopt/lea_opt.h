@@ -0,0 +1,74 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const size_t LEA128_ROUNDS = 24;
+static const size_t LEA192_ROUNDS = 28;
+static const size_t LEA256_ROUNDS = 32;
+
+/**
+ * Where the six round key words of a round sit. The standard layout stores all six; the
+ * compact LEA-128 one stores T0..T3 once, since words 1, 3 and 5 are all T1.
+ */
+template <bool Compact>
+struct lea_rk_layout {
+    static const size_t words = 6;
+    static const size_t k3 = 3;
+    static const size_t k4 = 4;
+    static const size_t k5 = 5;
+};
+
+template <>
+struct lea_rk_layout<true> {
+    static const size_t words = 4;
+    static const size_t k3 = 1;
+    static const size_t k4 = 3;
+    static const size_t k5 = 1;
+};
+
+/**
+ * Multi-block backends for x86 hosts. Each vector lane holds one 32-bit word of a different
+ * block and every round key word is broadcast, so the round function is the scalar one on
+ * four (SSE2) or eight (AVX2) blocks at a time. Picked at runtime from CPUID, define
+ * LEA_NO_SIMD to build the scalar code only.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(LEA_NO_SIMD)
+#define LEA_SIMD 1
+#define LEA_SSE2_TARGET __attribute__((target("sse2")))
+#define LEA_AVX2_TARGET __attribute__((target("avx2")))
+
+bool lea_sse2_available();
+bool lea_avx2_available();
+template <size_t Rounds, bool Compact> LEA_SSE2_TARGET void lea_sse2_encrypt4(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template <size_t Rounds, bool Compact> LEA_SSE2_TARGET void lea_sse2_decrypt4(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template <size_t Rounds, bool Compact> LEA_AVX2_TARGET void lea_avx2_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+template <size_t Rounds, bool Compact> LEA_AVX2_TARGET void lea_avx2_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+#endif
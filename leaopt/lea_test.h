@@ -33,6 +33,22 @@
 void print_hex(const char* title, const uint8_t* data, size_t count);
 void lea128_encrypt_test();
 void lea128_decrypt_test();
+void lea128_compact_test();
+void lea_otf_test();
+void lea_ctr_cache_test();
+void lea128_otf_benchmark();
+void lea128_unroll_benchmark();
+void lea192_test();
+void lea256_test();
+void lea_encrypt8_test();
+void lea128_bulk_benchmark();
+void lea_const_keygen_test();
+void lea128_blob_test();
+void lea128_blob_benchmark();
 void lea128_benchmark();
 void lea128_ecb_test();
-void lea128_ctr_test();
\ No newline at end of file
+void lea128_ctr_test();
+void lea_ctx_test();
+void lea128_ctx_benchmark();
+void lea_cbc_test();
+void lea128_cbc_benchmark();
\ No newline at end of file
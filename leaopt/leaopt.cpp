@@ -27,12 +27,10 @@
 
 
 #include "lea.h"
+#include "lea_opt.h"
+#include "HardwareSerial.h"
 #include <string.h>
 
-const static size_t LEA128_ROUNDS = 24;
-const static size_t LEA192_ROUNDS = 28;
-const static size_t LEA256_ROUNDS = 32;
-
 const static uint32_t DELTA[8]= {
     0xc3efe9db, 0x44626b02, 0x79e27c8a, 0x78df30ec,
     0x715ea49e, 0xc785da0a, 0xe04ef22a, 0xe5c40957,
@@ -45,7 +43,7 @@ static inline uint32_t rot32r1(uint32_t value)
 
 static inline uint32_t rot32r8(uint32_t value)
 {
-    return (value >> 8) | (value >> 24);
+    return (value >> 8) | (value << 24);
 }
 
 static inline uint32_t rot32r9(uint32_t value)
@@ -68,21 +66,31 @@ static inline uint32_t rot32l9(uint32_t value)
     return rot32l8(rot32l1(value));
 }
 
+// the key schedules rotate by round + j, which reaches 0 and values past 31
 static inline uint32_t rol32(uint32_t value, size_t rot)
 {
-    return (value << rot) | (value >> (32 - rot));
+    return (value << (rot & 31)) | (value >> ((32 - rot) & 31));
 }
 
 static inline uint32_t ror32(uint32_t value, size_t rot)
 {
-    return (value >> rot) | (value << (32 - rot));
+    return (value >> (rot & 31)) | (value << ((32 - rot) & 31));
+}
+
+// one key schedule word update, T = ROL(T + ROL(delta, shift), rot)
+static inline uint32_t key_step(uint32_t t, uint32_t delta, size_t shift, size_t rot)
+{
+    return rol32(t + rol32(delta, shift), rot);
 }
 
 /**
- * LEA 128-bit block, 128-bit key 
+ * LEA 128-bit block, 128-bit key. Words 1, 3 and 5 of every round key are T1, the compact
+ * layout stores it once.
  */
-void lea128_keygen(uint8_t* out, const uint8_t* mk)
+template <bool Compact>
+static void lea128_keygen_layout(uint8_t* out, const uint8_t* mk)
 {
+    typedef lea_rk_layout<Compact> L;
     const uint32_t* t = (const uint32_t*) mk;
     uint32_t* rk = (uint32_t*) out;
     
@@ -102,16 +110,130 @@ void lea128_keygen(uint8_t* out, const uint8_t* mk)
         rk[0] = t0;
         rk[1] = t1;
         rk[2] = t2;
-        rk[3] = t1;
-        rk[4] = t3;
-        rk[5] = t1;
-        rk += 6;
+        rk[L::k3] = t1;
+        rk[L::k4] = t3;
+        rk[L::k5] = t1;
+        rk += L::words;
     }
 }
 
-void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+void lea128_keygen(uint8_t* out, const uint8_t* mk)
+{
+    lea128_keygen_layout<false>(out, mk);
+}
+
+void lea128_keygen_compact(uint8_t* out, const uint8_t* mk)
+{
+    lea128_keygen_layout<true>(out, mk);
+}
+
+/**
+ * Round key words for one round. A schedule in flash on AVR is copied out a round at a time,
+ * otherwise the words are read in place.
+ */
+template <bool Flash>
+static inline const uint32_t* round_key(uint32_t* copy, const uint32_t* rk)
+{
+#if defined(__AVR__)
+    if (Flash) {
+        memcpy_P(copy, rk, 24);
+        return copy;
+    }
+#else
+    (void) copy;
+#endif
+    return rk;
+}
+
+/**
+ * Count encryption rounds, unrolled at compile time. Each round writes its results over
+ * words 1 to 3 and the next one takes the words renamed (b1, b2, b3, b0), so no word moves.
+ */
+template <size_t Count, bool Flash, bool Compact>
+struct encrypt_rounds {
+    static inline void run(uint32_t& b0, uint32_t& b1, uint32_t& b2, uint32_t& b3, const uint32_t*& rk, uint32_t* copy)
+    {
+        typedef lea_rk_layout<Compact> L;
+        const uint32_t* k = round_key<Flash>(copy, rk);
+
+        b3 = ror32((b2 ^ k[L::k4]) + (b3 ^ k[L::k5]), 3);
+        b2 = ror32((b1 ^ k[2]) + (b2 ^ k[L::k3]), 5);
+        b1 = rot32l9((b0 ^ k[0]) + (b1 ^ k[1]));
+        rk += L::words;
+
+        encrypt_rounds<Count - 1, Flash, Compact>::run(b1, b2, b3, b0, rk, copy);
+    }
+};
+
+template <bool Flash, bool Compact>
+struct encrypt_rounds<0, Flash, Compact> {
+    static inline void run(uint32_t&, uint32_t&, uint32_t&, uint32_t&, const uint32_t*&, uint32_t*)
+    {
+    }
+};
+
+// the inverse rounds, walking the schedule backwards and renaming the words (b3, b0, b1, b2)
+template <size_t Count, bool Flash, bool Compact>
+struct decrypt_rounds {
+    static inline void run(uint32_t& b0, uint32_t& b1, uint32_t& b2, uint32_t& b3, const uint32_t*& rk, uint32_t* copy)
+    {
+        typedef lea_rk_layout<Compact> L;
+        const uint32_t* k = round_key<Flash>(copy, rk);
+
+        b0 = (rot32r9(b0) - (b3 ^ k[0])) ^ k[1];
+        b1 = (rol32(b1, 5) - (b0 ^ k[2])) ^ k[L::k3];
+        b2 = (rol32(b2, 3) - (b1 ^ k[L::k4])) ^ k[L::k5];
+        rk -= L::words;
+
+        decrypt_rounds<Count - 1, Flash, Compact>::run(b3, b0, b1, b2, rk, copy);
+    }
+};
+
+template <bool Flash, bool Compact>
+struct decrypt_rounds<0, Flash, Compact> {
+    static inline void run(uint32_t&, uint32_t&, uint32_t&, uint32_t&, const uint32_t*&, uint32_t*)
+    {
+    }
+};
+
+// moves the words Shift places down, undoing the renaming left over by an unroll factor below 4
+template <size_t Shift>
+static inline void rotate_words(uint32_t& b0, uint32_t& b1, uint32_t& b2, uint32_t& b3)
+{
+    for (size_t i = 0; i < Shift; ++i) {
+        uint32_t t = b0;
+        b0 = b1;
+        b1 = b2;
+        b2 = b3;
+        b3 = t;
+    }
+}
+
+/**
+ * Count rounds from rk, Unroll of them per loop iteration: 1, 2, 4 or LEA_UNROLL_FULL for
+ * straight-line code. Count is a multiple of 4, the words end up in the variables they started in.
+ */
+template <size_t Count, bool Flash, bool Compact, size_t Unroll>
+static inline void encrypt_words(uint32_t& b0, uint32_t& b1, uint32_t& b2, uint32_t& b3, const uint32_t*& rk, uint32_t* copy)
+{
+    const size_t unroll = (Unroll == LEA_UNROLL_FULL) ? Count : Unroll;
+    static_assert(Count % unroll == 0, "the unroll factor must divide the round count");
+
+    for (size_t round = 0; round < Count; round += unroll)
+    {
+        encrypt_rounds<unroll, Flash, Compact>::run(b0, b1, b2, b3, rk, copy);
+        rotate_words<unroll % 4>(b0, b1, b2, b3);
+    }
+}
+
+/**
+ * Rounds is 24, 28 or 32, see encrypt_words for Unroll. Compact schedules are never in flash.
+ */
+template <size_t Rounds, bool Flash, bool Compact = false, size_t Unroll = LEA_UNROLL>
+static void lea_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
 {
     const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t copy[6];
     const uint32_t* block = (const uint32_t*) in;
     uint32_t* outblk = (uint32_t*) out;
 
@@ -120,28 +242,623 @@ void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
     uint32_t b2 = block[2];
     uint32_t b3 = block[3];
 
-    for (size_t round = 0; round < LEA128_ROUNDS; round += 4)
+    encrypt_words<Rounds, Flash, Compact, Unroll>(b0, b1, b2, b3, rk, copy);
+
+    outblk[0] = b0;
+    outblk[1] = b1;
+    outblk[2] = b2;
+    outblk[3] = b3;
+}
+
+template <size_t Rounds, bool Flash, bool Compact = false, size_t Unroll = LEA_UNROLL>
+static void lea_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    const size_t unroll = (Unroll == LEA_UNROLL_FULL) ? Rounds : Unroll;
+    static_assert(Rounds % unroll == 0, "the unroll factor must divide the round count");
+
+    const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t copy[6];
+    const uint32_t* block = (const uint32_t*) in;
+    uint32_t* outblk = (uint32_t*) out;
+
+    uint32_t b0 = block[0];
+    uint32_t b1 = block[1];
+    uint32_t b2 = block[2];
+    uint32_t b3 = block[3];
+
+    rk += lea_rk_layout<Compact>::words * (Rounds - 1);
+    for (size_t round = 0; round < Rounds; round += unroll)
     {
-        b3 = ror32((b2 ^ rk[4]) + (b3 ^ rk[5]), 3);
-        b2 = ror32((b1 ^ rk[2]) + (b2 ^ rk[3]), 5);
-        b1 = rot32l9((b0 ^ rk[0]) + (b1 ^ rk[1]));
+        decrypt_rounds<unroll, Flash, Compact>::run(b0, b1, b2, b3, rk, copy);
+        rotate_words<(4 - unroll % 4) % 4>(b0, b1, b2, b3);
+    }
+
+    outblk[0] = b0;
+    outblk[1] = b1;
+    outblk[2] = b2;
+    outblk[3] = b3;
+}
+
+/**
+ * LEA_BULK_BLOCKS blocks per call: AVX2 takes all of them at once, SSE2 four at a time,
+ * without either the blocks go one by one through the scalar kernel
+ */
+template <size_t Rounds, bool Compact = false>
+static void lea_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+#if defined(LEA_SIMD)
+    if (lea_avx2_available()) {
+        lea_avx2_encrypt8<Rounds, Compact>(out, in, rks);
+        return;
+    }
+    if (lea_sse2_available()) {
+        lea_sse2_encrypt4<Rounds, Compact>(out, in, rks);
+        lea_sse2_encrypt4<Rounds, Compact>(out + 64, in + 64, rks);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < LEA_BULK_BLOCKS; ++i) {
+        lea_encrypt<Rounds, false, Compact>(out + 16 * i, in + 16 * i, rks);
+    }
+}
+
+template <size_t Rounds, bool Compact = false>
+static void lea_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+#if defined(LEA_SIMD)
+    if (lea_avx2_available()) {
+        lea_avx2_decrypt8<Rounds, Compact>(out, in, rks);
+        return;
+    }
+    if (lea_sse2_available()) {
+        lea_sse2_decrypt4<Rounds, Compact>(out, in, rks);
+        lea_sse2_decrypt4<Rounds, Compact>(out + 64, in + 64, rks);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < LEA_BULK_BLOCKS; ++i) {
+        lea_decrypt<Rounds, false, Compact>(out + 16 * i, in + 16 * i, rks);
+    }
+}
+
+/**
+ * Rounds 1 and 2 of a counter block that only changes in word 3. Round 1 outputs words 0, 1
+ * and 3 without it, round 2 word 0 and 3, so a block needs three of the six round 1 and 2
+ * updates. The cache holds those words pre-xored with their round keys, and the three round
+ * key words still needed.
+ */
+struct ctr_cache {
+    uint32_t b2;
+    uint32_t k5;
+    uint32_t x1;
+    uint32_t x3;
+    uint32_t k13;
+    uint32_t k14;
+    uint32_t y0;
+    uint32_t y3;
+};
+
+template <bool Flash, bool Compact>
+static void ctr_prepare(ctr_cache& c, const uint32_t* b, const uint32_t* rk, uint32_t* copy)
+{
+    typedef lea_rk_layout<Compact> L;
+
+    const uint32_t* k = round_key<Flash>(copy, rk);
+    uint32_t x0 = rot32l9((b[0] ^ k[0]) + (b[1] ^ k[1]));
+    uint32_t x1 = ror32((b[1] ^ k[2]) + (b[2] ^ k[L::k3]), 5);
+    c.b2 = b[2] ^ k[L::k4];
+    c.k5 = k[L::k5];
+
+    k = round_key<Flash>(copy, rk + L::words);
+    c.y0 = rot32l9((x0 ^ k[0]) + (x1 ^ k[1]));
+    c.x1 = x1 ^ k[2];
+    c.k13 = k[L::k3];
+    c.k14 = k[L::k4];
+    c.x3 = b[0] ^ k[L::k5];
+    c.y3 = x0;
+}
+
+// big endian counter increment, returns the index of the most significant byte that changed
+static size_t increment_counter(uint8_t* ctr)
+{
+    size_t idx = 15;
+    while (++ctr[idx] == 0 && idx != 0) {
+        --idx;
+    }
+    return idx;
+}
+
+/**
+ * Whole CTR blocks: full runs of LEA_BULK_BLOCKS go to the SIMD kernels when there are any,
+ * the rest start from the cached rounds 1 and 2, refreshed when the carry leaves word 3
+ * (counter bytes 12 to 15)
+ */
+template <size_t Rounds, bool Flash, bool Compact>
+static void lea_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    typedef lea_rk_layout<Compact> L;
+
+#if defined(LEA_SIMD)
+    if (lea_avx2_available() || lea_sse2_available()) {
+        const size_t bulksize = LEA_BULK_BLOCKS * 16;
+        uint8_t counters[bulksize];
+        uint8_t keystreams[bulksize];
+
+        while (blocks >= LEA_BULK_BLOCKS) {
+            for (size_t i = 0; i < bulksize; i += 16) {
+                memcpy(counters + i, ctr, 16);
+                increment_counter(ctr);
+            }
+
+            lea_encrypt8<Rounds, Compact>(keystreams, counters, rks);
+            for (size_t i = 0; i < bulksize; ++i) {
+                out[i] = in[i] ^ keystreams[i];
+            }
+
+            in += bulksize;
+            out += bulksize;
+            blocks -= LEA_BULK_BLOCKS;
+        }
+    }
+#endif
+
+    uint32_t copy[6];
+    uint32_t block[4];
+    uint32_t keystream[4];
+    ctr_cache c = {};
+    bool stale = true;
+
+    for (; blocks > 0; --blocks) {
+        memcpy(block, ctr, 16);
+        if (stale) {
+            ctr_prepare<Flash, Compact>(c, block, (const uint32_t*) rks, copy);
+        }
+
+        const uint32_t* rk = (const uint32_t*) rks + 2 * L::words;
+        uint32_t x2 = ror32(c.b2 + (block[3] ^ c.k5), 3);
+        uint32_t y0 = c.y0;
+        uint32_t y1 = ror32(c.x1 + (x2 ^ c.k13), 5);
+        uint32_t y2 = ror32((x2 ^ c.k14) + c.x3, 3);
+        uint32_t y3 = c.y3;
+
+        // two more rounds leave the words renamed (y2, y3, y0, y1), the rest come in fours
+        encrypt_rounds<2, Flash, Compact>::run(y0, y1, y2, y3, rk, copy);
+        encrypt_words<Rounds - 4, Flash, Compact, LEA_UNROLL>(y2, y3, y0, y1, rk, copy);
+
+        keystream[0] = y2;
+        keystream[1] = y3;
+        keystream[2] = y0;
+        keystream[3] = y1;
+
+        const uint8_t* ks = (const uint8_t*) keystream;
+        for (size_t i = 0; i < 16; ++i) {
+            out[i] = in[i] ^ ks[i];
+        }
+
+        stale = increment_counter(ctr) < 12;
+        in += 16;
+        out += 16;
+    }
+}
+
+const char* lea_backend_name()
+{
+#if defined(LEA_SIMD)
+    if (lea_avx2_available()) {
+        return "AVX2, 8 blocks";
+    }
+    if (lea_sse2_available()) {
+        return "SSE2, 4 blocks";
+    }
+#endif
+
+    return "scalar";
+}
+
+void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA128_ROUNDS, false>(out, in, rks);
+}
+
+void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA128_ROUNDS, false>(out, in, rks);
+}
+
+void lea128_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt8<LEA128_ROUNDS>(out, in, rks);
+}
+
+void lea128_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt8<LEA128_ROUNDS>(out, in, rks);
+}
+
+void lea128_encrypt_unroll(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t unroll)
+{
+    switch (unroll) {
+    case 1:
+        lea_encrypt<LEA128_ROUNDS, false, false, 1>(out, in, rks);
+        return;
+    case 2:
+        lea_encrypt<LEA128_ROUNDS, false, false, 2>(out, in, rks);
+        return;
+    case 4:
+        lea_encrypt<LEA128_ROUNDS, false, false, 4>(out, in, rks);
+        return;
+    case LEA_UNROLL_FULL:
+        lea_encrypt<LEA128_ROUNDS, false, false, LEA_UNROLL_FULL>(out, in, rks);
+        return;
+    }
+
+    Serial.println("unroll factor is not 1, 2, 4 or LEA_UNROLL_FULL");
+}
+
+void lea128_encrypt_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA128_ROUNDS, false, true>(out, in, rks);
+}
+
+void lea128_decrypt_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA128_ROUNDS, false, true>(out, in, rks);
+}
+
+void lea128_encrypt8_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt8<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+void lea128_decrypt8_compact(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt8<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+void lea128_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA128_ROUNDS, false, false>(out, in, ctr, rks, blocks);
+}
+
+void lea128_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA128_ROUNDS, true, false>(out, in, ctr, rks, blocks);
+}
+
+void lea128_encrypt_ctr_compact(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA128_ROUNDS, false, true>(out, in, ctr, rks, blocks);
+}
+
+void lea128_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+void lea128_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA128_ROUNDS, true>(out, in, rks);
+}
+
+/**
+ * LEA 128-bit block, 192-bit key: six key words, each its own round key word
+ */
+void lea192_keygen(uint8_t* out, const uint8_t* mk)
+{
+    const uint32_t* t = (const uint32_t*) mk;
+    uint32_t* rk = (uint32_t*) out;
+
+    uint32_t t0 = t[0];
+    uint32_t t1 = t[1];
+    uint32_t t2 = t[2];
+    uint32_t t3 = t[3];
+    uint32_t t4 = t[4];
+    uint32_t t5 = t[5];
+
+    for(size_t round = 0; round < LEA192_ROUNDS; ++round) {
+        uint32_t delta = DELTA[round % 6];
+
+        t0 = key_step(t0, delta, round, 1);
+        t1 = key_step(t1, delta, round + 1, 3);
+        t2 = key_step(t2, delta, round + 2, 6);
+        t3 = key_step(t3, delta, round + 3, 11);
+        t4 = key_step(t4, delta, round + 4, 13);
+        t5 = key_step(t5, delta, round + 5, 17);
+
+        rk[0] = t0;
+        rk[1] = t1;
+        rk[2] = t2;
+        rk[3] = t3;
+        rk[4] = t4;
+        rk[5] = t5;
         rk += 6;
+    }
+}
+
+void lea192_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA192_ROUNDS, false>(out, in, rks);
+}
+
+void lea192_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA192_ROUNDS, false>(out, in, rks);
+}
+
+void lea192_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt8<LEA192_ROUNDS>(out, in, rks);
+}
 
-        b0 = ror32((b3 ^ rk[4]) + (b0 ^ rk[5]), 3);
-        b3 = ror32((b2 ^ rk[2]) + (b3 ^ rk[3]), 5);
-        b2 = rot32l9((b1 ^ rk[0]) + (b2 ^ rk[1]));
+void lea192_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt8<LEA192_ROUNDS>(out, in, rks);
+}
+
+void lea192_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA192_ROUNDS, false, false>(out, in, ctr, rks, blocks);
+}
+
+void lea192_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA192_ROUNDS, true, false>(out, in, ctr, rks, blocks);
+}
+
+void lea192_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA192_ROUNDS, true>(out, in, rks);
+}
+
+void lea192_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA192_ROUNDS, true>(out, in, rks);
+}
+
+/**
+ * LEA 128-bit block, 256-bit key: every round updates six of the eight key words, starting
+ * where the previous round stopped, so the word order repeats every four rounds
+ */
+void lea256_keygen(uint8_t* out, const uint8_t* mk)
+{
+    const uint32_t* t = (const uint32_t*) mk;
+    uint32_t* rk = (uint32_t*) out;
+
+    uint32_t t0 = t[0];
+    uint32_t t1 = t[1];
+    uint32_t t2 = t[2];
+    uint32_t t3 = t[3];
+    uint32_t t4 = t[4];
+    uint32_t t5 = t[5];
+    uint32_t t6 = t[6];
+    uint32_t t7 = t[7];
+
+    for(size_t round = 0; round < LEA256_ROUNDS; round += 4) {
+        uint32_t delta = DELTA[round & 7];
+
+        t0 = key_step(t0, delta, round, 1);
+        t1 = key_step(t1, delta, round + 1, 3);
+        t2 = key_step(t2, delta, round + 2, 6);
+        t3 = key_step(t3, delta, round + 3, 11);
+        t4 = key_step(t4, delta, round + 4, 13);
+        t5 = key_step(t5, delta, round + 5, 17);
+
+        rk[0] = t0;
+        rk[1] = t1;
+        rk[2] = t2;
+        rk[3] = t3;
+        rk[4] = t4;
+        rk[5] = t5;
         rk += 6;
 
-        b1 = ror32((b0 ^ rk[4]) + (b1 ^ rk[5]), 3);
-        b0 = ror32((b3 ^ rk[2]) + (b0 ^ rk[3]), 5);
-        b3 = rot32l9((b2 ^ rk[0]) + (b3 ^ rk[1]));
+        delta = DELTA[(round + 1) & 7];
+
+        t6 = key_step(t6, delta, round + 1, 1);
+        t7 = key_step(t7, delta, round + 2, 3);
+        t0 = key_step(t0, delta, round + 3, 6);
+        t1 = key_step(t1, delta, round + 4, 11);
+        t2 = key_step(t2, delta, round + 5, 13);
+        t3 = key_step(t3, delta, round + 6, 17);
+
+        rk[0] = t6;
+        rk[1] = t7;
+        rk[2] = t0;
+        rk[3] = t1;
+        rk[4] = t2;
+        rk[5] = t3;
         rk += 6;
 
-        b2 = ror32((b1 ^ rk[4]) + (b2 ^ rk[5]), 3);
-        b1 = ror32((b0 ^ rk[2]) + (b1 ^ rk[3]), 5);
-        b0 = rot32l9((b3 ^ rk[0]) + (b0 ^ rk[1]));
+        delta = DELTA[(round + 2) & 7];
+
+        t4 = key_step(t4, delta, round + 2, 1);
+        t5 = key_step(t5, delta, round + 3, 3);
+        t6 = key_step(t6, delta, round + 4, 6);
+        t7 = key_step(t7, delta, round + 5, 11);
+        t0 = key_step(t0, delta, round + 6, 13);
+        t1 = key_step(t1, delta, round + 7, 17);
+
+        rk[0] = t4;
+        rk[1] = t5;
+        rk[2] = t6;
+        rk[3] = t7;
+        rk[4] = t0;
+        rk[5] = t1;
+        rk += 6;
+
+        delta = DELTA[(round + 3) & 7];
+
+        t2 = key_step(t2, delta, round + 3, 1);
+        t3 = key_step(t3, delta, round + 4, 3);
+        t4 = key_step(t4, delta, round + 5, 6);
+        t5 = key_step(t5, delta, round + 6, 11);
+        t6 = key_step(t6, delta, round + 7, 13);
+        t7 = key_step(t7, delta, round + 8, 17);
+
+        rk[0] = t2;
+        rk[1] = t3;
+        rk[2] = t4;
+        rk[3] = t5;
+        rk[4] = t6;
+        rk[5] = t7;
         rk += 6;
     }
+}
+
+void lea256_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA256_ROUNDS, false>(out, in, rks);
+}
+
+void lea256_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA256_ROUNDS, false>(out, in, rks);
+}
+
+void lea256_encrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt8<LEA256_ROUNDS>(out, in, rks);
+}
+
+void lea256_decrypt8(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt8<LEA256_ROUNDS>(out, in, rks);
+}
+
+void lea256_encrypt_ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA256_ROUNDS, false, false>(out, in, ctr, rks, blocks);
+}
+
+void lea256_encrypt_ctr_P(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+{
+    lea_ctr<LEA256_ROUNDS, true, false>(out, in, ctr, rks, blocks);
+}
+
+void lea256_encrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_encrypt<LEA256_ROUNDS, true>(out, in, rks);
+}
+
+void lea256_decrypt_P(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+{
+    lea_decrypt<LEA256_ROUNDS, true>(out, in, rks);
+}
+
+// rotation of key word j in every key schedule step
+static const size_t KEY_ROT[6] = {1, 3, 6, 11, 13, 17};
+
+/**
+ * On-the-fly schedule: t holds the Nk key words and is advanced by one round, writing that
+ * round's six key words to k. LEA-192 updates all six words every round, LEA-256 the six
+ * starting where the previous round stopped.
+ */
+template <size_t Nk>
+static inline void otf_next(uint32_t* t, uint32_t* k, size_t round)
+{
+    uint32_t delta = DELTA[round % Nk];
+
+    if (Nk == 4) {
+        t[0] = key_step(t[0], delta, round, 1);
+        t[1] = key_step(t[1], delta, round + 1, 3);
+        t[2] = key_step(t[2], delta, round + 2, 6);
+        t[3] = key_step(t[3], delta, round + 3, 11);
+
+        k[0] = t[0];
+        k[1] = t[1];
+        k[2] = t[2];
+        k[3] = t[1];
+        k[4] = t[3];
+        k[5] = t[1];
+        return;
+    }
+
+    for (size_t j = 0; j < 6; ++j) {
+        size_t idx = (6 * round + j) % Nk;
+        t[idx] = key_step(t[idx], delta, round + j, KEY_ROT[j]);
+        k[j] = t[idx];
+    }
+}
+
+// the reverse: reads the key words of round from t, then steps t back to the round before
+template <size_t Nk>
+static inline void otf_prev(uint32_t* t, uint32_t* k, size_t round)
+{
+    uint32_t delta = DELTA[round % Nk];
+
+    if (Nk == 4) {
+        k[0] = t[0];
+        k[1] = t[1];
+        k[2] = t[2];
+        k[3] = t[1];
+        k[4] = t[3];
+        k[5] = t[1];
+
+        t[0] = ror32(t[0], 1) - rol32(delta, round);
+        t[1] = ror32(t[1], 3) - rol32(delta, round + 1);
+        t[2] = ror32(t[2], 6) - rol32(delta, round + 2);
+        t[3] = ror32(t[3], 11) - rol32(delta, round + 3);
+        return;
+    }
+
+    for (size_t j = 0; j < 6; ++j) {
+        size_t idx = (6 * round + j) % Nk;
+        k[j] = t[idx];
+        t[idx] = ror32(t[idx], KEY_ROT[j]) - rol32(delta, round + j);
+    }
+}
+
+template <size_t Rounds, size_t Nk>
+static void lea_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    uint32_t t[Nk];
+    uint32_t k[6];
+
+    memcpy(t, mk, sizeof(t));
+    for (size_t round = 0; round < Rounds; ++round) {
+        otf_next<Nk>(t, k, round);
+    }
+    memcpy(dk, t, sizeof(t));
+}
+
+template <size_t Rounds, size_t Nk>
+static void lea_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk)
+{
+    uint32_t t[Nk];
+    uint32_t k[6];
+    const uint32_t* block = (const uint32_t*) in;
+    uint32_t* outblk = (uint32_t*) out;
+
+    memcpy(t, mk, sizeof(t));
+
+    uint32_t b0 = block[0];
+    uint32_t b1 = block[1];
+    uint32_t b2 = block[2];
+    uint32_t b3 = block[3];
+
+    for (size_t round = 0; round < Rounds; round += 4)
+    {
+        otf_next<Nk>(t, k, round);
+        b3 = ror32((b2 ^ k[4]) + (b3 ^ k[5]), 3);
+        b2 = ror32((b1 ^ k[2]) + (b2 ^ k[3]), 5);
+        b1 = rot32l9((b0 ^ k[0]) + (b1 ^ k[1]));
+
+        otf_next<Nk>(t, k, round + 1);
+        b0 = ror32((b3 ^ k[4]) + (b0 ^ k[5]), 3);
+        b3 = ror32((b2 ^ k[2]) + (b3 ^ k[3]), 5);
+        b2 = rot32l9((b1 ^ k[0]) + (b2 ^ k[1]));
+
+        otf_next<Nk>(t, k, round + 2);
+        b1 = ror32((b0 ^ k[4]) + (b1 ^ k[5]), 3);
+        b0 = ror32((b3 ^ k[2]) + (b0 ^ k[3]), 5);
+        b3 = rot32l9((b2 ^ k[0]) + (b3 ^ k[1]));
+
+        otf_next<Nk>(t, k, round + 3);
+        b2 = ror32((b1 ^ k[4]) + (b2 ^ k[5]), 3);
+        b1 = ror32((b0 ^ k[2]) + (b1 ^ k[3]), 5);
+        b0 = rot32l9((b3 ^ k[0]) + (b0 ^ k[1]));
+    }
 
     outblk[0] = b0;
     outblk[1] = b1;
@@ -149,39 +866,42 @@ void lea128_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
     outblk[3] = b3;
 }
 
-void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+template <size_t Rounds, size_t Nk>
+static void lea_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk)
 {
-    const uint32_t* rk = (const uint32_t*) rks;
+    uint32_t t[Nk];
+    uint32_t k[6];
     const uint32_t* block = (const uint32_t*) in;
     uint32_t* outblk = (uint32_t*) out;
 
+    memcpy(t, dk, sizeof(t));
+
     uint32_t b0 = block[0];
     uint32_t b1 = block[1];
     uint32_t b2 = block[2];
     uint32_t b3 = block[3];
 
-    rk += 6 * (LEA128_ROUNDS - 1);
-    for (size_t round = 0; round < LEA128_ROUNDS; round += 4)
+    for (size_t round = Rounds; round > 0; round -= 4)
     {
-        b0 = (rot32r9(b0) - (b3 ^ rk[0])) ^ rk[1];
-        b1 = (rol32(b1, 5) - (b0 ^ rk[2])) ^ rk[3];
-        b2 = (rol32(b2, 3) - (b1 ^ rk[4])) ^ rk[5];
-        rk -= 6;
+        otf_prev<Nk>(t, k, round - 1);
+        b0 = (rot32r9(b0) - (b3 ^ k[0])) ^ k[1];
+        b1 = (rol32(b1, 5) - (b0 ^ k[2])) ^ k[3];
+        b2 = (rol32(b2, 3) - (b1 ^ k[4])) ^ k[5];
 
-        b3 = (rot32r9(b3) - (b2 ^ rk[0])) ^ rk[1];
-        b0 = (rol32(b0, 5) - (b3 ^ rk[2])) ^ rk[3];
-        b1 = (rol32(b1, 3) - (b0 ^ rk[4])) ^ rk[5];
-        rk -= 6;
+        otf_prev<Nk>(t, k, round - 2);
+        b3 = (rot32r9(b3) - (b2 ^ k[0])) ^ k[1];
+        b0 = (rol32(b0, 5) - (b3 ^ k[2])) ^ k[3];
+        b1 = (rol32(b1, 3) - (b0 ^ k[4])) ^ k[5];
 
-        b2 = (rot32r9(b2) - (b1 ^ rk[0])) ^ rk[1];
-        b3 = (rol32(b3, 5) - (b2 ^ rk[2])) ^ rk[3];
-        b0 = (rol32(b0, 3) - (b3 ^ rk[4])) ^ rk[5];
-        rk -= 6;
+        otf_prev<Nk>(t, k, round - 3);
+        b2 = (rot32r9(b2) - (b1 ^ k[0])) ^ k[1];
+        b3 = (rol32(b3, 5) - (b2 ^ k[2])) ^ k[3];
+        b0 = (rol32(b0, 3) - (b3 ^ k[4])) ^ k[5];
 
-        b1 = (rot32r9(b1) - (b0 ^ rk[0])) ^ rk[1];
-        b2 = (rol32(b2, 5) - (b1 ^ rk[2])) ^ rk[3];
-        b3 = (rol32(b3, 3) - (b2 ^ rk[4])) ^ rk[5];
-        rk -= 6;
+        otf_prev<Nk>(t, k, round - 4);
+        b1 = (rot32r9(b1) - (b0 ^ k[0])) ^ k[1];
+        b2 = (rol32(b2, 5) - (b1 ^ k[2])) ^ k[3];
+        b3 = (rol32(b3, 3) - (b2 ^ k[4])) ^ k[5];
     }
 
     outblk[0] = b0;
@@ -189,3 +909,48 @@ void lea128_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
     outblk[2] = b2;
     outblk[3] = b3;
 }
+
+void lea128_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    lea_keygen_otf_decrypt<LEA128_ROUNDS, 4>(dk, mk);
+}
+
+void lea128_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk)
+{
+    lea_encrypt_otf<LEA128_ROUNDS, 4>(out, in, mk);
+}
+
+void lea128_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk)
+{
+    lea_decrypt_otf<LEA128_ROUNDS, 4>(out, in, dk);
+}
+
+void lea192_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    lea_keygen_otf_decrypt<LEA192_ROUNDS, 6>(dk, mk);
+}
+
+void lea192_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk)
+{
+    lea_encrypt_otf<LEA192_ROUNDS, 6>(out, in, mk);
+}
+
+void lea192_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk)
+{
+    lea_decrypt_otf<LEA192_ROUNDS, 6>(out, in, dk);
+}
+
+void lea256_keygen_otf_decrypt(uint8_t* dk, const uint8_t* mk)
+{
+    lea_keygen_otf_decrypt<LEA256_ROUNDS, 8>(dk, mk);
+}
+
+void lea256_encrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* mk)
+{
+    lea_encrypt_otf<LEA256_ROUNDS, 8>(out, in, mk);
+}
+
+void lea256_decrypt_otf(uint8_t* out, const uint8_t* in, const uint8_t* dk)
+{
+    lea_decrypt_otf<LEA256_ROUNDS, 8>(out, in, dk);
+}
@@ -34,12 +34,28 @@ void setup() {
 
     lea128_encrypt_test();
     lea128_decrypt_test();
+    lea128_compact_test();
+    lea_otf_test();
+    lea_ctr_cache_test();
+    lea192_test();
+    lea256_test();
+    lea_encrypt8_test();
+    lea_const_keygen_test();
+    lea128_blob_test();
+    lea_ctx_test();
+    lea_cbc_test();
 }
 
 void loop() {
     lea128_benchmark();
+    lea128_blob_benchmark();
+    lea128_bulk_benchmark();
+    lea128_otf_benchmark();
+    lea128_unroll_benchmark();
     lea128_ecb_test();
     lea128_ctr_test();
+    lea128_ctx_benchmark();
+    lea128_cbc_benchmark();
 
     delay(2000);
 }
@@ -0,0 +1,467 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2019 Ilwoong Jeong, https://github.com/ilwoong
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Block cipher modes of operation for 16-byte blocks, templated on a cipher policy so that
+ * every block call inside a mode is a direct call, and the compiler can inline the cipher
+ * where it sees it. The sketches include it from this library as <block_mode.h>.
+ *
+ * A policy is usually a mode_cipher below and provides:
+ *   RKS_SIZE, DRKS_SIZE   schedule bytes for encryption and for decryption
+ *   keygen, keygen_decrypt
+ *   encrypt, decrypt      one block
+ *   BULK_BLOCKS           blocks per encrypt_bulk and decrypt_bulk call, 1 when there are none
+ *   WHOLE_CTR             true when ctr xors whole keystream blocks and advances the counter itself
+ */
+typedef void (*mode_keygen_function)(uint8_t* rks, const uint8_t* mk);
+typedef void (*mode_block_function)(uint8_t* out, const uint8_t* in, const uint8_t* rks);
+typedef void (*mode_whole_ctr_function)(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks);
+
+// keygen of on-the-fly ciphers, whose encryption schedule is the key itself
+template <size_t KeySize>
+void mode_copy_key(uint8_t* rks, const uint8_t* mk)
+{
+    memcpy(rks, mk, KeySize);
+}
+
+/**
+ * Optional kernels of a policy. Each one is a tag type that states what it provides, so the
+ * capabilities are plain constants: comparing function addresses with nullptr is not a
+ * constant expression under -fno-delete-null-pointer-checks, which avr-gcc always passes.
+ */
+struct mode_no_ctr {
+    static const bool WHOLE_CTR = false;
+};
+
+template <mode_whole_ctr_function Ctr>
+struct mode_ctr_kernel {
+    static const bool WHOLE_CTR = true;
+
+    static void ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t blocks)
+    {
+        Ctr(out, in, ctr, rks, blocks);
+    }
+};
+
+struct mode_no_bulk {
+    static const size_t BULK_BLOCKS = 1;
+};
+
+template <size_t Blocks, mode_block_function EncryptBulk, mode_block_function DecryptBulk>
+struct mode_bulk_kernel {
+    static const size_t BULK_BLOCKS = Blocks;
+
+    static void encrypt_bulk(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        EncryptBulk(out, in, rks);
+    }
+
+    static void decrypt_bulk(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        DecryptBulk(out, in, rks);
+    }
+};
+
+/**
+ * Policy over the functions of one key size. CtrKernel is mode_no_ctr or a mode_ctr_kernel,
+ * BulkKernel is mode_no_bulk or a mode_bulk_kernel.
+ */
+template <size_t KeySize, size_t RksSize, size_t DrksSize,
+          mode_keygen_function Keygen, mode_keygen_function KeygenDecrypt,
+          mode_block_function Encrypt, mode_block_function Decrypt,
+          typename CtrKernel = mode_no_ctr, typename BulkKernel = mode_no_bulk>
+struct mode_cipher : CtrKernel, BulkKernel {
+    static const size_t KEY_SIZE = KeySize;
+    static const size_t RKS_SIZE = RksSize;
+    static const size_t DRKS_SIZE = DrksSize;
+
+    static void keygen(uint8_t* rks, const uint8_t* mk)
+    {
+        Keygen(rks, mk);
+    }
+
+    static void keygen_decrypt(uint8_t* rks, const uint8_t* mk)
+    {
+        KeygenDecrypt(rks, mk);
+    }
+
+    static void encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        Encrypt(out, in, rks);
+    }
+
+    static void decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        Decrypt(out, in, rks);
+    }
+};
+
+static inline void mode_xor_bytes(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs, size_t length)
+{
+    for (size_t i = 0; i < length; ++i) {
+        out[i] = lhs[i] ^ rhs[i];
+    }
+}
+
+// one block, out may be lhs or rhs: the loads all come before the store, which lets it vectorize
+static inline void mode_xor_block(uint8_t* out, const uint8_t* lhs, const uint8_t* rhs)
+{
+    uint8_t block[16];
+    for (size_t i = 0; i < 16; ++i) {
+        block[i] = lhs[i] ^ rhs[i];
+    }
+    memcpy(out, block, 16);
+}
+
+// big endian increment of a 16-byte counter block
+static inline void mode_increase_counter(uint8_t* ctr)
+{
+    size_t idx = 15;
+    while (++ctr[idx] == 0 && idx != 0) {
+        --idx;
+    }
+}
+
+/**
+ * Multi-block runs, picked at compile time: the general case has none and leaves every
+ * block to the caller, the specialization takes whole runs and returns the bytes it did.
+ * decrypt_run decrypts BLOCKS blocks, which is a single one in the general case. ctr
+ * encrypts runs of counter blocks and advances ctr past them.
+ */
+template <typename Cipher, bool Bulk = (Cipher::BULK_BLOCKS > 1)>
+struct mode_bulk {
+    static const size_t BLOCKS = 1;
+    static const size_t BULK_SIZE = 16 * BLOCKS;
+
+    static void decrypt_run(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        Cipher::decrypt(out, in, rks);
+    }
+
+    static size_t encrypt(uint8_t*, const uint8_t*, const uint8_t*, size_t)
+    {
+        return 0;
+    }
+
+    static size_t decrypt(uint8_t*, const uint8_t*, const uint8_t*, size_t)
+    {
+        return 0;
+    }
+
+    static size_t ctr(uint8_t*, const uint8_t*, uint8_t*, const uint8_t*, size_t)
+    {
+        return 0;
+    }
+};
+
+template <typename Cipher>
+struct mode_bulk<Cipher, true> {
+    static const size_t BLOCKS = Cipher::BULK_BLOCKS;
+    static const size_t BULK_SIZE = 16 * BLOCKS;
+
+    static void decrypt_run(uint8_t* out, const uint8_t* in, const uint8_t* rks)
+    {
+        Cipher::decrypt_bulk(out, in, rks);
+    }
+
+    static size_t encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t length)
+    {
+        size_t done = 0;
+        for (; length - done >= BULK_SIZE; done += BULK_SIZE) {
+            Cipher::encrypt_bulk(out + done, in + done, rks);
+        }
+        return done;
+    }
+
+    static size_t decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t length)
+    {
+        size_t done = 0;
+        for (; length - done >= BULK_SIZE; done += BULK_SIZE) {
+            Cipher::decrypt_bulk(out + done, in + done, rks);
+        }
+        return done;
+    }
+
+    static size_t ctr(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t length)
+    {
+        uint8_t counters[BULK_SIZE];
+        uint8_t keystream[BULK_SIZE];
+
+        size_t done = 0;
+        for (; length - done >= BULK_SIZE; done += BULK_SIZE) {
+            for (size_t i = 0; i < BULK_SIZE; i += 16) {
+                memcpy(counters + i, ctr, 16);
+                mode_increase_counter(ctr);
+            }
+            Cipher::encrypt_bulk(keystream, counters, rks);
+            mode_xor_bytes(out + done, in + done, keystream, BULK_SIZE);
+        }
+        return done;
+    }
+};
+
+/**
+ * The same for a whole-block CTR function, which advances ctr past the blocks it did. Without
+ * one, runs of counter blocks still go through the multi-block function when there is one.
+ */
+template <typename Cipher, bool Whole = Cipher::WHOLE_CTR>
+struct mode_whole_ctr {
+    static size_t run(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t length)
+    {
+        return mode_bulk<Cipher>::ctr(out, in, ctr, rks, length);
+    }
+};
+
+template <typename Cipher>
+struct mode_whole_ctr<Cipher, true> {
+    static size_t run(uint8_t* out, const uint8_t* in, uint8_t* ctr, const uint8_t* rks, size_t length)
+    {
+        size_t blocks = length / 16;
+        Cipher::ctr(out, in, ctr, rks, blocks);
+        return 16 * blocks;
+    }
+};
+
+// length is a multiple of 16, rks the encryption schedule
+template <typename Cipher>
+void mode_ecb_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t length)
+{
+    size_t done = mode_bulk<Cipher>::encrypt(out, in, rks, length);
+
+    for (; done < length; done += 16) {
+        Cipher::encrypt(out + done, in + done, rks);
+    }
+}
+
+// length is a multiple of 16, rks the decryption schedule
+template <typename Cipher>
+void mode_ecb_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t length)
+{
+    size_t done = mode_bulk<Cipher>::decrypt(out, in, rks, length);
+
+    for (; done < length; done += 16) {
+        Cipher::decrypt(out + done, in + done, rks);
+    }
+}
+
+// any length, the last keystream block is cut short; CTR decryption is the same call
+template <typename Cipher>
+void mode_ctr_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, const uint8_t* ctr, size_t length)
+{
+    uint8_t keystream[16];
+    uint8_t ctr_copy[16];
+
+    memcpy(ctr_copy, ctr, 16);
+
+    size_t done = mode_whole_ctr<Cipher>::run(out, in, ctr_copy, rks, length);
+
+    for (; length - done >= 16; done += 16) {
+        Cipher::encrypt(keystream, ctr_copy, rks);
+        mode_xor_bytes(out + done, in + done, keystream, 16);
+        mode_increase_counter(ctr_copy);
+    }
+
+    if (done < length) {
+        Cipher::encrypt(keystream, ctr_copy, rks);
+        mode_xor_bytes(out + done, in + done, keystream, length - done);
+    }
+}
+
+// length is a multiple of 16, out and in are the same buffer or do not overlap
+template <typename Cipher>
+void mode_cbc_encrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, const uint8_t* iv, size_t length)
+{
+    uint8_t block[16];
+    const uint8_t* chain = iv;
+
+    for (size_t done = 0; done < length; done += 16) {
+        mode_xor_block(block, in + done, chain);
+        Cipher::encrypt(out + done, block, rks);
+        chain = out + done;
+    }
+}
+
+/**
+ * out = plain ^ the ciphertext block before each block of a run at in, last block first;
+ * first tells that the run starts the message, whose first block takes the iv
+ */
+static inline void mode_cbc_unchain(uint8_t* out, const uint8_t* plain, const uint8_t* in, const uint8_t* iv, bool first, size_t length)
+{
+    for (size_t i = length; i > 0; ) {
+        i -= 16;
+        const uint8_t* chain = (i == 0 && first) ? iv : in + i - 16;
+        mode_xor_block(out + i, plain + i, chain);
+    }
+}
+
+/**
+ * Blocks of CBC decryption are independent, so they go through the multi-block function when
+ * there is one. Runs are taken from the end backwards: in place, every block then still finds
+ * the ciphertext before it. A run decrypted in place overwrites its own ciphertext, so only
+ * then it goes through a stack buffer of one run; otherwise it is decrypted into out and
+ * unchained there. BULK_SIZE is an in-class constant, so the buffer is a fixed-size array on
+ * every target. length and the buffers are as for mode_cbc_encrypt.
+ */
+template <typename Cipher>
+void mode_cbc_decrypt(uint8_t* out, const uint8_t* in, const uint8_t* rks, const uint8_t* iv, size_t length)
+{
+    const size_t run = mode_bulk<Cipher>::BULK_SIZE;
+
+    uint8_t buffer[mode_bulk<Cipher>::BULK_SIZE];
+    size_t end = length;
+
+    while (end >= run) {
+        end -= run;
+        uint8_t* plain = (out == in) ? buffer : out + end;
+        mode_bulk<Cipher>::decrypt_run(plain, in + end, rks);
+        mode_cbc_unchain(out + end, plain, in + end, iv, end == 0, run);
+    }
+
+    while (end > 0) {
+        end -= 16;
+        Cipher::decrypt(buffer, in + end, rks);
+        mode_cbc_unchain(out + end, buffer, in + end, iv, end == 0, 16);
+    }
+}
+
+/**
+ * The same from the key, expanded into a schedule of exactly the policy's size on the stack
+ */
+template <typename Cipher>
+void mode_ecb_encrypt_key(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+{
+    uint8_t rks[Cipher::RKS_SIZE];
+    Cipher::keygen(rks, key);
+    mode_ecb_encrypt<Cipher>(out, in, rks, length);
+}
+
+template <typename Cipher>
+void mode_ecb_decrypt_key(uint8_t* out, const uint8_t* in, const uint8_t* key, size_t length)
+{
+    uint8_t rks[Cipher::DRKS_SIZE];
+    Cipher::keygen_decrypt(rks, key);
+    mode_ecb_decrypt<Cipher>(out, in, rks, length);
+}
+
+template <typename Cipher>
+void mode_ctr_encrypt_key(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* ctr, size_t length)
+{
+    uint8_t rks[Cipher::RKS_SIZE];
+    Cipher::keygen(rks, key);
+    mode_ctr_encrypt<Cipher>(out, in, rks, ctr, length);
+}
+
+template <typename Cipher>
+void mode_cbc_encrypt_key(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* iv, size_t length)
+{
+    uint8_t rks[Cipher::RKS_SIZE];
+    Cipher::keygen(rks, key);
+    mode_cbc_encrypt<Cipher>(out, in, rks, iv, length);
+}
+
+template <typename Cipher>
+void mode_cbc_decrypt_key(uint8_t* out, const uint8_t* in, const uint8_t* key, const uint8_t* iv, size_t length)
+{
+    uint8_t rks[Cipher::DRKS_SIZE];
+    Cipher::keygen_decrypt(rks, key);
+    mode_cbc_decrypt<Cipher>(out, in, rks, iv, length);
+}
+
+typedef void (*mode_ecb_function)(uint8_t* out, const uint8_t* in, const uint8_t* rks, size_t length);
+typedef void (*mode_ctr_function)(uint8_t* out, const uint8_t* in, const uint8_t* rks, const uint8_t* ctr, size_t length);
+typedef void (*mode_cbc_function)(uint8_t* out, const uint8_t* in, const uint8_t* rks, const uint8_t* iv, size_t length);
+
+/**
+ * Mode functions of one key size for callers that pick the key size at run time. That costs
+ * one indirect call per message; the blocks inside still run on direct calls. The _key
+ * entries take the key, the others a schedule, and the _P entries a schedule in flash.
+ *
+ * A table holds 17 pointers, 34 bytes on AVR, so it lives in flash there and entries are
+ * read with mode_table_read. Taking every entry's address links every ECB, CTR and CBC
+ * function of the cipher into the sketch, even when the sketch calls only one mode.
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define MODE_TABLE_MEM PROGMEM
+#define mode_table_read(table, entry) ((decltype((table)->entry)) pgm_read_ptr(&(table)->entry))
+#else
+#define MODE_TABLE_MEM
+#define mode_table_read(table, entry) ((table)->entry)
+#endif
+
+struct mode_table {
+    mode_keygen_function keygen;
+    mode_keygen_function keygen_decrypt;
+    mode_ecb_function ecb_encrypt_key;
+    mode_ecb_function ecb_decrypt_key;
+    mode_ctr_function ctr_encrypt_key;
+    mode_cbc_function cbc_encrypt_key;
+    mode_cbc_function cbc_decrypt_key;
+    mode_ecb_function ecb_encrypt;
+    mode_ecb_function ecb_decrypt;
+    mode_ctr_function ctr_encrypt;
+    mode_cbc_function cbc_encrypt;
+    mode_cbc_function cbc_decrypt;
+    mode_ecb_function ecb_encrypt_P;
+    mode_ecb_function ecb_decrypt_P;
+    mode_ctr_function ctr_encrypt_P;
+    mode_cbc_function cbc_encrypt_P;
+    mode_cbc_function cbc_decrypt_P;
+};
+
+// Cipher works on schedules in RAM, CipherP on schedules in flash
+template <typename Cipher, typename CipherP>
+struct mode_table_of {
+    static const mode_table table;
+};
+
+template <typename Cipher, typename CipherP>
+const mode_table mode_table_of<Cipher, CipherP>::table MODE_TABLE_MEM = {
+    Cipher::keygen,
+    Cipher::keygen_decrypt,
+    mode_ecb_encrypt_key<Cipher>,
+    mode_ecb_decrypt_key<Cipher>,
+    mode_ctr_encrypt_key<Cipher>,
+    mode_cbc_encrypt_key<Cipher>,
+    mode_cbc_decrypt_key<Cipher>,
+    mode_ecb_encrypt<Cipher>,
+    mode_ecb_decrypt<Cipher>,
+    mode_ctr_encrypt<Cipher>,
+    mode_cbc_encrypt<Cipher>,
+    mode_cbc_decrypt<Cipher>,
+    mode_ecb_encrypt<CipherP>,
+    mode_ecb_decrypt<CipherP>,
+    mode_ctr_encrypt<CipherP>,
+    mode_cbc_encrypt<CipherP>,
+    mode_cbc_decrypt<CipherP>,
+};